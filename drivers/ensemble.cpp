@@ -0,0 +1,159 @@
+/**
+ * @class ensemble.cpp
+ * @brief Command line driver for ensemble runs
+ * @details Runs perturbed copies of a scene across all cores and streams a
+ *          CSV summary line per body per member to stdout
+ *
+ * Usage: Ensemble [--scene file] [--members N] [--steps N] [--dt seconds]
+ *                 [--sigma relative] [--seed N] [--threads N]
+ *
+ * I affirm that this work is my own
+ * 2016-11-30
+ * @author Edward Goode
+ * VuID: goodees
+ * Email: edward.s.goode@vanderbilt.edu
+ */
+
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include "../include/Ensemble.h"
+#include "../include/FastFormat.h"
+#include "../include/Object.h"
+#include "../include/ObjectFactory.h"
+#include "../include/Parser.h"
+#include "../include/SceneFile.h"
+#include "../include/ThreadPool.h"
+#include "../include/Universe.h"
+
+/**
+ *  Prints the usage message and returns the exit code to use.
+ */
+int usage(const char *program){
+    std::cerr << "Usage: " << program << " [--scene file] [--members N] [--steps N]"
+              << " [--dt seconds] [--sigma relative] [--seed N] [--threads N]" << std::endl;
+    return 1;
+}
+
+/**
+ *  Parses text as a whole decimal count into count. Returns false if text is
+ *  not one or does not fit.
+ */
+bool parseCount(const char *text, unsigned long &count){
+    // strtoul accepts a sign and silently negates, so digits are required.
+    if (!std::isdigit(static_cast<unsigned char>(*text)))
+        return false;
+    char *end;
+    errno = 0;
+    count = std::strtoul(text, &end, 10);
+    return errno == 0 && *end == '\0';
+}
+
+/**
+ *  Parses text as a whole finite number into real. Returns false if text is
+ *  not one.
+ */
+bool parseReal(const char *text, double &real){
+    char *end;
+    real = std::strtod(text, &end);
+    return end != text && *end == '\0' && std::isfinite(real);
+}
+
+/**
+ *  Populates universe with the sun/earth system used by the UMC test.
+ */
+void makeDefaultScene(Universe &universe){
+    vector2 position;
+    vector2 velocity;
+    position[0] = 149597870700.0;
+    velocity[1] = 29788.4676;
+    universe.addObject(ObjectFactory::makeObject("sun", 1.98892e30));
+    universe.addObject(ObjectFactory::makeObject("earth", 5.9742e24, position, velocity));
+}
+
+int main(int argc, char **argv){
+    const char *scene = nullptr;
+    size_t members = 1000;
+    size_t steps = 86400;
+    double dt = 1.0;
+    double sigma = 1e-6;
+    unsigned long seed = 1;
+    size_t threads = 0;
+
+    for (int i = 1; i < argc; i++){
+        if (i + 1 == argc)
+            return usage(argv[0]);
+
+        const char *option = argv[i];
+        const char *value = argv[++i];
+        unsigned long count;
+        double real;
+        if (std::strcmp(option, "--scene") == 0)
+            scene = value;
+        else if (std::strcmp(option, "--members") == 0 && parseCount(value, count))
+            members = count;
+        else if (std::strcmp(option, "--steps") == 0 && parseCount(value, count))
+            steps = count;
+        else if (std::strcmp(option, "--dt") == 0 && parseReal(value, real) && real > 0)
+            dt = real;
+        else if (std::strcmp(option, "--sigma") == 0 && parseReal(value, real) && real >= 0)
+            sigma = real;
+        else if (std::strcmp(option, "--seed") == 0 && parseCount(value, count))
+            seed = count;
+        else if (std::strcmp(option, "--threads") == 0 && parseCount(value, count))
+            threads = count;
+        else
+            return usage(argv[0]);
+    }
+
+    std::unique_ptr<Universe> base(Universe::instance());
+    try {
+        if (scene != nullptr && SceneFile::isSceneFile(scene)){
+            SceneFile(scene).addTo(*base);
+        } else if (scene != nullptr){
+            Parser parser;
+            parser.loadFile(scene);
+        }
+    } catch (const std::exception &e) {
+        std::cerr << "Unable to load " << scene << ": " << e.what() << std::endl;
+        return 1;
+    }
+
+    if (base->begin() == base->end())
+        makeDefaultScene(*base);
+
+    ThreadPool pool(threads);
+    Ensemble ensemble(*base, Ensemble::velocityNoise(sigma, seed));
+
+    std::cout << "member,body,x,y,vx,vy,energy_drift" << std::endl;
+    std::string lines;
+    ensemble.run(members, steps, dt, pool, [&lines](const MemberSummary &summary) {
+        const UniverseState &state = *summary.finalState;
+        double drift = (summary.finalEnergy - summary.initialEnergy) / summary.initialEnergy;
+        const std::string member = std::to_string(summary.member);
+
+        // Numbers are written with the shortest text that reads back exactly.
+        lines.clear();
+        for (size_t body = 0; body < state.size(); body++){
+            lines += member;
+            lines += ',';
+            lines += state.names[body];
+            for (double value : {state.positions[body][0], state.positions[body][1],
+                                 state.velocities[body][0], state.velocities[body][1], drift}){
+                lines += ',';
+                FastFormat::append(value, lines);
+            }
+            lines += '\n';
+        }
+        std::cout.write(lines.data(), lines.size());
+        std::cout.flush();
+    });
+
+    return 0;
+}
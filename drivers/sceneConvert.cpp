@@ -0,0 +1,84 @@
+/**
+ * @class sceneConvert.cpp
+ * @brief Converts scenes between the text and the binary scene format
+ * @details Text scripts ({name, mass, [x y], [vx vy]} per line) are written
+ *          as binary scene files and binary scene files as text scripts. The
+ *          direction is chosen by the contents of the input file. Numbers are
+ *          written with the shortest text that reads back exactly, so a round
+ *          trip through both formats is lossless.
+ *
+ * Usage: scene_convert input output
+ *
+ * I affirm that this work is my own
+ * 2016-11-30
+ * @author Edward Goode
+ * VuID: goodees
+ * Email: edward.s.goode@vanderbilt.edu
+ */
+
+#include <cstdio>
+#include <exception>
+#include <iostream>
+#include <string>
+#include "../include/FastFormat.h"
+#include "../include/Object.h"
+#include "../include/Parser.h"
+#include "../include/SceneFile.h"
+#include "../include/Universe.h"
+
+/**
+ *  Writes the bodies of universe to path as a text script. Returns false if
+ *  path cannot be written.
+ */
+bool writeText(const char *path, const Universe &universe){
+    std::FILE *file = std::fopen(path, "wb");
+    if (!file)
+        return false;
+
+    std::string line;
+    bool written = true;
+    for (Universe::const_iterator i = universe.begin(); i != universe.end(); ++i){
+        const Object &object = **i;
+        const vector2 position = object.getPosition();
+        const vector2 velocity = object.getVelocity();
+
+        line = "{" + object.getName() + ", ";
+        FastFormat::append(object.getMass(), line);
+        line += ", [";
+        FastFormat::append(position[0], line);
+        line += ' ';
+        FastFormat::append(position[1], line);
+        line += "], [";
+        FastFormat::append(velocity[0], line);
+        line += ' ';
+        FastFormat::append(velocity[1], line);
+        line += "]}\n";
+        written = written && std::fwrite(line.data(), 1, line.size(), file) == line.size();
+    }
+    return std::fclose(file) == 0 && written;
+}
+
+int main(int argc, char **argv){
+    if (argc != 3){
+        std::cerr << "Usage: " << argv[0] << " input output" << std::endl;
+        return 1;
+    }
+
+    try {
+        Universe universe;
+        if (SceneFile::isSceneFile(argv[1])){
+            SceneFile(argv[1]).addTo(universe);
+            if (!writeText(argv[2], universe)){
+                std::cerr << "Unable to write " << argv[2] << std::endl;
+                return 1;
+            }
+        } else {
+            Parser(universe).loadFile(argv[1]);
+            SceneFile::write(argv[2], universe);
+        }
+    } catch (const std::exception &e){
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
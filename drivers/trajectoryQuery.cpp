@@ -0,0 +1,143 @@
+/**
+ * @class trajectoryQuery.cpp
+ * @brief Prints parts of a trajectory file
+ * @details Without a time range, prints a summary of the file. With one,
+ *          prints a CSV line (time, step, name, x, y, vx, vy) per sample in
+ *          [begin, end) and body, for the named bodies or all of them. Only
+ *          the chunks and columns needed are read. With --at, prints a CSV
+ *          line (time, name, x, y, vx, vy, error) per body with its state
+ *          interpolated at time and the estimated error of its position.
+ *
+ * Usage: trajectory_query file [begin end [body...]]
+ *        trajectory_query file --at time [body...]
+ *
+ * I affirm that this work is my own
+ * 2016-11-30
+ * @author Edward Goode
+ * VuID: goodees
+ * Email: edward.s.goode@vanderbilt.edu
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../include/FastFormat.h"
+#include "../include/TrajectoryInterpolator.h"
+#include "../include/TrajectoryReader.h"
+#include "../include/TrajectoryRecorder.h"
+
+/**
+ *  Prints the bodies, samples and chunks of reader.
+ */
+void printSummary(const TrajectoryReader &reader){
+    const size_t samples = reader.getSampleCount();
+    std::cout << "bodies: " << reader.getBodyCount() << "\n"
+              << "samples: " << samples << " every " << reader.getInterval() << " steps\n"
+              << "chunks: " << reader.getChunkCount() << (reader.isIndexed() ? "" : " (no index)") << "\n";
+    if (samples != 0){
+        std::string line = "time: ";
+        FastFormat::append(reader.getTime(0), line);
+        line += " to ";
+        FastFormat::append(reader.getTime(samples - 1), line);
+        std::cout << line << "\n";
+    }
+}
+
+/**
+ *  Parses text as a time. Returns false if it is not a number.
+ */
+bool parseTime(const char *text, double &time){
+    char *end;
+    time = std::strtod(text, &end);
+    return end != text && *end == '\0';
+}
+
+/**
+ *  Prints the states of bodies of reader interpolated at time.
+ */
+void printInterpolated(const TrajectoryReader &reader, double time, const std::vector<size_t> &bodies){
+    TrajectoryInterpolator interpolator(reader);
+    std::vector<TrajectoryInterpolator::State> states;
+    interpolator.interpolate(time, bodies, states);
+
+    std::string line;
+    for (size_t b = 0; b < bodies.size(); b++){
+        const TrajectoryInterpolator::State &state = states[b];
+        line.clear();
+        FastFormat::append(time, line);
+        line += ',' + reader.getName(bodies[b]);
+        const double values[] = {state.position[0], state.position[1], state.velocity[0],
+                                 state.velocity[1], state.error};
+        for (double value : values){
+            line += ',';
+            FastFormat::append(value, line);
+        }
+        line += '\n';
+        std::cout << line;
+    }
+}
+
+int main(int argc, char **argv){
+    const bool at = argc >= 3 && std::string(argv[2]) == "--at";
+    double begin = 0, end = 0;
+    if (at ? argc < 4 || !parseTime(argv[3], begin)
+           : argc != 2 && (argc < 4 || !parseTime(argv[2], begin) || !parseTime(argv[3], end))){
+        std::cerr << "Usage: " << argv[0] << " file [begin end [body...]]\n"
+                  << "       " << argv[0] << " file --at time [body...]" << std::endl;
+        return 1;
+    }
+
+    try {
+        TrajectoryReader reader(argv[1]);
+        if (argc == 2){
+            printSummary(reader);
+            return 0;
+        }
+
+        std::vector<size_t> bodies;
+        for (int i = 4; i < argc; i++)
+            bodies.push_back(reader.findBody(argv[i]));
+        if (argc == 4)
+            for (size_t body = 0; body < reader.getBodyCount(); body++)
+                bodies.push_back(body);
+        if (at){
+            printInterpolated(reader, begin, bodies);
+            return 0;
+        }
+
+        std::vector<std::string> names;
+        for (size_t body : bodies)
+            names.push_back(reader.getName(body));
+
+        // Read in windows of bounded size, so that long ranges of many
+        // bodies do not have to fit in memory at once.
+        const size_t first = reader.findSample(begin);
+        const size_t last = reader.findSample(end);
+        const size_t windowSize = std::max<size_t>((1 << 20) / (bodies.size() + 1), 1);
+        TrajectoryReader::Window window;
+        std::string line;
+        for (size_t sample = first; sample < last; sample += window.size()){
+            reader.read(sample, std::min(windowSize, last - sample), bodies, window);
+            for (size_t s = 0; s < window.size(); s++)
+                for (size_t b = 0; b < bodies.size(); b++){
+                    line.clear();
+                    FastFormat::append(window.times[s], line);
+                    line += ',' + std::to_string(window.steps[s]) + ',' + names[b];
+                    const double *values = &window.values[(s * bodies.size() + b) * TrajectoryRecorder::quantities];
+                    for (size_t q = 0; q < TrajectoryRecorder::quantities; q++){
+                        line += ',';
+                        FastFormat::append(values[q], line);
+                    }
+                    line += '\n';
+                    std::cout << line;
+                }
+        }
+    } catch (const std::exception &e){
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
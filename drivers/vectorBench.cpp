@@ -0,0 +1,278 @@
+/**
+ * @class vectorBench.cpp
+ * @brief Microbenchmarks for the Vector operations
+ * @details Times every Vector operation for several dimensions, prints ns/op
+ *          and throughput, and optionally compares the results against (or
+ *          records them as) a JSON baseline so regressions in the vector math
+ *          are caught. Build with CMAKE_BUILD_TYPE=Release for meaningful
+ *          numbers.
+ *
+ * Usage: vector_bench [--baseline file] [--write-baseline file]
+ *                     [--tolerance fraction] [--min-time seconds]
+ *
+ * Exits with status 2 if any operation is slower than its baseline by more
+ * than the tolerance (0.25 by default).
+ *
+ * I affirm that this work is my own
+ * 2016-11-30
+ * @author Edward Goode
+ * VuID: goodees
+ * Email: edward.s.goode@vanderbilt.edu
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../include/Vector.h"
+
+/**
+ *  The time taken by one benchmarked operation.
+ */
+struct Result {
+    std::string name;
+    double nsPerOp;
+};
+
+/**
+ *  Prints the usage message and returns the exit code to use.
+ */
+int usage(const char *program){
+    std::cerr << "Usage: " << program << " [--baseline file] [--write-baseline file]"
+              << " [--tolerance fraction] [--min-time seconds]" << std::endl;
+    return 1;
+}
+
+/**
+ *  Forces the compiler to assume that value is read, so that the work which
+ *  produced it cannot be optimized away.
+ */
+template <typename T>
+inline void keep(const T &value){
+#if defined(__GNUC__)
+    __asm__ __volatile__("" : : "r"(&value) : "memory");
+#else
+    static volatile const void *sink;
+    sink = &value;
+#endif
+}
+
+/**
+ *  Returns the average time in ns of one of the ops operations performed by
+ *  each call of batch, doubling the number of calls until they take at least
+ *  minSeconds.
+ */
+template <typename Batch>
+double measure(Batch batch, size_t ops, double minSeconds){
+    typedef std::chrono::steady_clock clock;
+
+    // Warm up caches and branch predictors.
+    batch();
+
+    for (size_t calls = 1; ; calls *= 2){
+        clock::time_point start = clock::now();
+        for (size_t call = 0; call < calls; call++)
+            batch();
+        double seconds = std::chrono::duration<double>(clock::now() - start).count();
+
+        if (seconds >= minSeconds)
+            return seconds * 1e9 / (calls * ops);
+    }
+}
+
+/**
+ *  Appends the timings of every operation on Vector<DIM> to results.
+ */
+template <size_t DIM>
+void benchmark(std::vector<Result> &results, double minSeconds){
+    const size_t count = 256;
+    std::vector<Vector<DIM> > a(count), b(count), out(count);
+
+    // Deterministic, well scaled inputs without zero vectors.
+    unsigned long state = 12345;
+    for (size_t i = 0; i < count; i++)
+        for (size_t d = 0; d < DIM; d++){
+            state = state * 6364136223846793005UL + 1442695040888963407UL;
+            a[i][d] = 1.0 + (state >> 40) / double(1UL << 24);
+            b[i][d] = 2.0 - (state >> 20 & 0xffffff) / double(1UL << 24);
+        }
+
+    const std::string prefix = "vector" + std::to_string(DIM) + ".";
+
+    results.push_back({prefix + "add", measure([&]() {
+        for (size_t i = 0; i < count; i++)
+            out[i] = a[i].add(b[i]);
+        keep(out[0]);
+    }, count, minSeconds)});
+
+    results.push_back({prefix + "scale", measure([&]() {
+        for (size_t i = 0; i < count; i++)
+            out[i] = a[i].scale(1.5);
+        keep(out[0]);
+    }, count, minSeconds)});
+
+    results.push_back({prefix + "axpy", measure([&]() {
+        for (size_t i = 0; i < count; i++)
+            out[i].axpy(1e-9, a[i]);
+        keep(out[0]);
+    }, count, minSeconds)});
+
+    results.push_back({prefix + "expression", measure([&]() {
+        for (size_t i = 0; i < count; i++)
+            out[i] = 0.5 * (a[i] - b[i]) + out[i];
+        keep(out[0]);
+    }, count, minSeconds)});
+
+    results.push_back({prefix + "dot", measure([&]() {
+        double sum = 0;
+        for (size_t i = 0; i < count; i++)
+            sum += a[i].dot(b[i]);
+        keep(sum);
+    }, count, minSeconds)});
+
+    results.push_back({prefix + "norm", measure([&]() {
+        double sum = 0;
+        for (size_t i = 0; i < count; i++)
+            sum += a[i].norm();
+        keep(sum);
+    }, count, minSeconds)});
+
+    results.push_back({prefix + "inverseNorm.refined", measure([&]() {
+        double sum = 0;
+        for (size_t i = 0; i < count; i++)
+            sum += a[i].inverseNorm(NormPrecision::refined);
+        keep(sum);
+    }, count, minSeconds)});
+
+    results.push_back({prefix + "normalize", measure([&]() {
+        for (size_t i = 0; i < count; i++){
+            out[i] = a[i];
+            out[i].normalize();
+        }
+        keep(out[0]);
+    }, count, minSeconds)});
+
+    if (DIM == 3)
+        results.push_back({prefix + "cross", measure([&]() {
+            for (size_t i = 0; i < count; i++)
+                out[i] = a[i].cross(b[i]);
+            keep(out[0]);
+        }, count, minSeconds)});
+
+    // Formatting is orders of magnitude slower, so fewer vectors are used.
+    const size_t strings = 16;
+    results.push_back({prefix + "toString", measure([&]() {
+        size_t length = 0;
+        for (size_t i = 0; i < strings; i++)
+            length += a[i].toString().size();
+        keep(length);
+    }, strings, minSeconds)});
+}
+
+/**
+ *  Reads a baseline written by writeBaseline: a flat JSON object mapping
+ *  operation names to ns/op. Returns false if path cannot be read.
+ */
+bool readBaseline(const char *path, std::map<std::string, double> &baseline){
+    std::ifstream in(path);
+    if (!in)
+        return false;
+
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    const std::string text = buffer.str();
+
+    // Every entry is "name": value; nothing else in the file is quoted.
+    size_t pos = 0;
+    while ((pos = text.find('"', pos)) != std::string::npos){
+        size_t end = text.find('"', pos + 1);
+        size_t colon = text.find(':', end);
+        if (end == std::string::npos || colon == std::string::npos)
+            break;
+        baseline[text.substr(pos + 1, end - pos - 1)] = std::strtod(text.c_str() + colon + 1, nullptr);
+        pos = colon + 1;
+    }
+    return true;
+}
+
+/**
+ *  Writes results to path as a flat JSON object mapping operation names to
+ *  ns/op. Returns false if path cannot be written.
+ */
+bool writeBaseline(const char *path, const std::vector<Result> &results){
+    std::ofstream out(path);
+    out << "{\n";
+    for (size_t i = 0; i < results.size(); i++){
+        char value[32];
+        std::snprintf(value, sizeof(value), "%.3f", results[i].nsPerOp);
+        out << "  \"" << results[i].name << "\": " << value
+            << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "}\n";
+    return bool(out);
+}
+
+int main(int argc, char **argv){
+    const char *baselinePath = nullptr;
+    const char *writePath = nullptr;
+    double tolerance = 0.25;
+    double minSeconds = 0.05;
+
+    for (int i = 1; i < argc; i++){
+        if (i + 1 == argc)
+            return usage(argv[0]);
+
+        const char *value = argv[++i];
+        if (std::strcmp(argv[i - 1], "--baseline") == 0)
+            baselinePath = value;
+        else if (std::strcmp(argv[i - 1], "--write-baseline") == 0)
+            writePath = value;
+        else if (std::strcmp(argv[i - 1], "--tolerance") == 0)
+            tolerance = std::strtod(value, nullptr);
+        else if (std::strcmp(argv[i - 1], "--min-time") == 0)
+            minSeconds = std::strtod(value, nullptr);
+        else
+            return usage(argv[0]);
+    }
+
+    std::map<std::string, double> baseline;
+    if (baselinePath && !readBaseline(baselinePath, baseline)){
+        std::cerr << "Could not read baseline " << baselinePath << std::endl;
+        return 1;
+    }
+
+    std::vector<Result> results;
+    benchmark<2>(results, minSeconds);
+    benchmark<3>(results, minSeconds);
+    benchmark<4>(results, minSeconds);
+    benchmark<8>(results, minSeconds);
+    benchmark<16>(results, minSeconds);
+
+    bool regressed = false;
+    std::printf("%-28s %10s %12s %10s %8s\n", "operation", "ns/op", "Mops/s", "baseline", "change");
+    for (const Result &result : results){
+        std::printf("%-28s %10.3f %12.1f", result.name.c_str(), result.nsPerOp, 1e3 / result.nsPerOp);
+
+        std::map<std::string, double>::const_iterator old = baseline.find(result.name);
+        if (old != baseline.end() && old->second > 0){
+            double change = result.nsPerOp / old->second - 1;
+            bool slower = change > tolerance;
+            regressed = regressed || slower;
+            std::printf(" %10.3f %+7.1f%%%s", old->second, 100 * change, slower ? "  REGRESSION" : "");
+        }
+        std::printf("\n");
+    }
+
+    if (writePath && !writeBaseline(writePath, results)){
+        std::cerr << "Could not write baseline " << writePath << std::endl;
+        return 1;
+    }
+
+    return regressed ? 2 : 0;
+}
@@ -0,0 +1,131 @@
+#ifndef _BATCHED_UNIVERSE_H_
+#define _BATCHED_UNIVERSE_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "Vector.h"
+
+// Forward declaration.
+class Universe;
+
+/**
+ *  Advances LANES copies of the same small system in lockstep. This is meant
+ *  for ensembles of identical systems (e.g. the sun/earth system with perturbed
+ *  velocities) where there are too few bodies to vectorize within a single
+ *  Universe. Every quantity is stored lane-minor, so the force and integrator
+ *  loops run over LANES contiguous doubles and the compiler can update 4 or 8
+ *  members per instruction.
+ *
+ *  The arithmetic mirrors Universe::stepSimulation operation for operation,
+ *  including its Summation, so lane k matches a Universe seeded with the
+ *  same bodies. As in Universe,
+ *  the first body is a "sun" that is never moved. Unlike Universe, bodies are
+ *  told apart by index rather than by name.
+ */
+template <size_t LANES>
+class BatchedUniverse {
+public:
+    /**
+     *  Creates a batch in which every lane is a copy of scene, summing forces
+     *  the way scene does.
+     */
+    explicit BatchedUniverse(const Universe &scene);
+
+    /**
+     *  Returns the number of bodies in each lane.
+     */
+    size_t size() const;
+
+    /**
+     *  Returns the name of body, shared by every lane.
+     */
+    const std::string & getName(size_t body) const;
+
+    /**
+     *  Returns the mass of body in lane.
+     */
+    double getMass(size_t body, size_t lane) const;
+
+    /**
+     *  Returns the position of body in lane.
+     */
+    vector2 getPosition(size_t body, size_t lane) const;
+
+    /**
+     *  Returns the velocity of body in lane.
+     */
+    vector2 getVelocity(size_t body, size_t lane) const;
+
+    /**
+     *  Sets the position of body in lane.
+     */
+    void setPosition(size_t body, size_t lane, const vector2 &pos);
+
+    /**
+     *  Sets the velocity of body in lane.
+     */
+    void setVelocity(size_t body, size_t lane, const vector2 &vel);
+
+    /**
+     *  Copies the masses, positions, and velocities of universe into lane.
+     *  throws an std::invalid_argument if the body counts differ.
+     */
+    void loadLane(size_t lane, const Universe &universe);
+
+    /**
+     *  Copies the positions and velocities of lane into the Objects of
+     *  universe. throws an std::invalid_argument if the body counts differ.
+     */
+    void storeLane(size_t lane, Universe &universe) const;
+
+    /**
+     *  Selects how the forces on each body are summed in every lane.
+     */
+    void setSummation(Summation summation);
+
+    /**
+     *  Returns how the forces on each body are summed.
+     */
+    Summation getSummation() const;
+
+    /**
+     *  Advances every lane by the provided time step.
+     */
+    void stepSimulation(const double &timeSec);
+
+private:
+    /**
+     *  Returns the offset of lane 0 of body in the storage below.
+     */
+    static size_t offset(size_t body);
+
+    /**
+     *  Names of the bodies.
+     */
+    std::vector<std::string> names_;
+
+    /**
+     *  Per-lane storage, indexed by offset(body) + lane.
+     */
+    std::vector<double> mass_;
+    std::vector<double> posX_;
+    std::vector<double> posY_;
+    std::vector<double> velX_;
+    std::vector<double> velY_;
+
+    /**
+     *  Scratch storage for the positions being computed by stepSimulation,
+     *  kept between steps so that stepping does not allocate.
+     */
+    std::vector<double> nextX_;
+    std::vector<double> nextY_;
+
+    /**
+     *  How the forces on each body are summed.
+     */
+    Summation summation_;
+};
+
+#include "../src/BatchedUniverse.cpp"
+#endif
@@ -0,0 +1,64 @@
+#ifndef _BINARY_FORMAT_H_
+#define _BINARY_FORMAT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Forward declaration
+class MappedFile;
+
+/**
+ *  The parts shared by the binary file formats (scene files, checkpoints and
+ *  trajectories). Every file starts with a header whose first 16 bytes are a
+ *  magic string of 8 bytes, a uint32_t byte order mark and a uint32_t
+ *  version. Files that name bodies follow it with a name table: count + 1
+ *  uint64_t offsets into the name data, where name i spans [offset i,
+ *  offset i + 1), then the name data itself, padded with zero bytes to a
+ *  multiple of 8.
+ *
+ *  Errors are thrown as std::runtime_errors whose message starts with the
+ *  name of the file and names the kind of file expected, e.g.
+ *  "scene.bin: truncated scene file".
+ */
+class BinaryFormat {
+public:
+    /**
+     *  Byte order mark written by every format. It reads back differently on
+     *  a machine of the other byte order.
+     */
+    static const uint32_t byteOrderMark = 0x01020304;
+
+    /**
+     *  Checks that file starts with a header of headerSize bytes that holds
+     *  magic, the byte order mark of this machine and version. throws an
+     *  std::runtime_error otherwise.
+     */
+    static void checkHeader(const MappedFile &file, size_t headerSize, const char *magic, uint32_t version,
+                            const std::string &filename, const std::string &kind);
+
+    /**
+     *  Checks the name table of count names and namesSize bytes of name data
+     *  at offset of file, and returns the offset just past its padding.
+     *  throws an std::runtime_error if it does not fit in the file or its
+     *  offsets do not increase within the name data.
+     */
+    static uint64_t checkNames(const MappedFile &file, uint64_t offset, uint64_t count, uint64_t namesSize,
+                               const std::string &filename, const std::string &kind);
+
+    /**
+     *  Checks the name table like checkNames, copies it to offsets and names,
+     *  and returns the offset just past its padding.
+     */
+    static uint64_t readNames(const MappedFile &file, uint64_t offset, uint64_t count, uint64_t namesSize,
+                              const std::string &filename, const std::string &kind,
+                              std::vector<uint64_t> &offsets, std::string &names);
+
+    /**
+     *  Returns the number of zero bytes that align size bytes to 8.
+     */
+    static uint64_t padding(uint64_t size);
+};
+
+#endif
@@ -0,0 +1,157 @@
+#ifndef _CHECKPOINT_H_
+#define _CHECKPOINT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Forward declaration
+class Universe;
+
+/**
+ *  The complete state of a Universe: its bodies, the simulated time, the step
+ *  counter and the integrator settings (publish interval and summation). A
+ *  restored Universe continues bit for bit as the original would have.
+ *
+ *  Checkpoints are written in a binary format laid out like a SceneFile, with
+ *  the simulation state added to the header: the name table followed by raw
+ *  columns of mass, position and velocity, so saving and restoring are bound
+ *  by memory and disk bandwidth. Files are written under a temporary name and
+ *  renamed once complete, so a crash while saving leaves the previous
+ *  checkpoint intact.
+ *
+ *  A Checkpoint object may be reused for every capture of a run so that its
+ *  storage is only allocated once.
+ */
+class Checkpoint {
+public:
+    /**
+     *  Version of the format written by write.
+     */
+    static const uint32_t version = 1;
+
+    /**
+     *  Creates an empty checkpoint.
+     */
+    Checkpoint();
+
+    /**
+     *  Captures the state of universe into filename.
+     */
+    static void save(const char *filename, const Universe &universe);
+
+    /**
+     *  Replaces the state of universe with the one saved in filename.
+     */
+    static void restore(const char *filename, Universe &universe);
+
+    /**
+     *  Copies the complete state of universe into this checkpoint.
+     */
+    void capture(const Universe &universe);
+
+    /**
+     *  Replaces the bodies and simulation state of universe with those of
+     *  this checkpoint. Published states are left alone.
+     */
+    void apply(Universe &universe) const;
+
+    /**
+     *  Writes the checkpoint to filename. throws an std::runtime_error if the
+     *  file cannot be written.
+     */
+    void write(const char *filename) const;
+
+    /**
+     *  Replaces this checkpoint with the one in filename. throws an
+     *  std::runtime_error if the file cannot be read or is not a complete
+     *  checkpoint of a known version written on a machine of the same byte
+     *  order, in which case this checkpoint is left unchanged.
+     */
+    void read(const char *filename);
+
+    /**
+     *  Returns the number of bodies.
+     */
+    size_t size() const;
+
+    /**
+     *  Returns the number of steps the Universe had taken.
+     */
+    size_t getStepCount() const;
+
+    /**
+     *  Returns the simulated time of the Universe in seconds.
+     */
+    double getTime() const;
+
+private:
+
+    /**
+     *  The start of every checkpoint file.
+     */
+    struct Header {
+        char magic[8];
+        uint32_t byteOrder;
+        uint32_t version;
+        uint64_t count;
+        uint64_t namesSize;
+        uint64_t steps;
+        double time;
+        uint64_t publishInterval;
+        uint64_t summation;
+    };
+
+    /**
+     *  Number of columns: mass, then position and velocity per dimension.
+     */
+    static const size_t columnCount = 5;
+
+    /**
+     *  Returns header with the magic, byte order mark and version filled in.
+     */
+    static Header makeHeader();
+
+    /**
+     *  Returns the number of zero bytes that align the names to 8 bytes.
+     */
+    size_t namePadding() const;
+
+    /**
+     *  The names of all bodies, back to back.
+     */
+    std::string names_;
+
+    /**
+     *  Name i spans [nameOffsets_[i], nameOffsets_[i + 1]) of names_.
+     */
+    std::vector<uint64_t> nameOffsets_;
+
+    /**
+     *  Mass, x, y, vx and vy of every body.
+     */
+    std::vector<double> columns_[columnCount];
+
+    /**
+     *  Number of steps taken.
+     */
+    uint64_t steps_;
+
+    /**
+     *  Simulated time in seconds.
+     */
+    double time_;
+
+    /**
+     *  Number of steps between published states.
+     */
+    uint64_t publishInterval_;
+
+    /**
+     *  How forces are summed, as the value of the Summation enumerator.
+     */
+    uint64_t summation_;
+};
+
+#endif
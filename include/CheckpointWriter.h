@@ -0,0 +1,122 @@
+#ifndef _CHECKPOINT_WRITER_H_
+#define _CHECKPOINT_WRITER_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "Checkpoint.h"
+
+// Forward declaration
+class Universe;
+
+/**
+ *  Writes checkpoints on a background thread so that the simulation only
+ *  pauses for as long as it takes to copy the state into memory.
+ *
+ *  Two Checkpoint buffers alternate: while one is being written to disk, the
+ *  next state is captured into the other. If a checkpoint is requested while
+ *  one is being written and another is already waiting, save blocks until the
+ *  write finishes, so at most two copies of the state exist at any time.
+ *
+ *  save and wait must be called from a single thread, normally the one that
+ *  steps the Universe.
+ */
+class CheckpointWriter {
+public:
+    /**
+     *  Starts the writer thread.
+     */
+    CheckpointWriter();
+
+    /**
+     *  Finishes writing every queued checkpoint and stops the writer thread.
+     *  Errors that were not reported by wait are ignored.
+     */
+    ~CheckpointWriter();
+
+    /**
+     *  Writers own their thread, so they may not be copied.
+     */
+    CheckpointWriter(const CheckpointWriter &) = delete;
+    CheckpointWriter & operator=(const CheckpointWriter &) = delete;
+
+    /**
+     *  Captures the state of universe and queues it to be written to
+     *  filename. Returns as soon as the state has been copied. If an earlier
+     *  checkpoint could not be written, its std::runtime_error is thrown
+     *  instead and nothing is captured.
+     */
+    void save(const char *filename, const Universe &universe);
+
+    /**
+     *  Blocks until every queued checkpoint has been written. If any could
+     *  not be written, the first such error is rethrown here.
+     */
+    void wait();
+
+private:
+
+    /**
+     *  Marks that no buffer is in the respective state.
+     */
+    static const size_t none = 2;
+
+    /**
+     *  Body of the writer thread.
+     */
+    void work();
+
+    /**
+     *  Rethrows and clears the first error of the writer thread, if any. The
+     *  caller must hold mutex_.
+     */
+    void rethrowError();
+
+    /**
+     *  The two capture buffers and the files they are written to.
+     */
+    Checkpoint buffers_[2];
+    std::string filenames_[2];
+
+    /**
+     *  Buffer waiting to be written, or none.
+     */
+    size_t pending_;
+
+    /**
+     *  Buffer being written, or none.
+     */
+    size_t writing_;
+
+    /**
+     *  Set by the destructor to stop the writer thread.
+     */
+    bool stopping_;
+
+    /**
+     *  First error of the writer thread since the last save or wait.
+     */
+    std::exception_ptr error_;
+
+    /**
+     *  Guards every member above except the buffers, which belong to the
+     *  writer thread from the moment they are queued until they are written.
+     */
+    std::mutex mutex_;
+
+    /**
+     *  Signalled whenever pending_, writing_ or stopping_ changes.
+     */
+    std::condition_variable changed_;
+
+    /**
+     *  The writer thread. Declared last so that it starts after everything
+     *  else has been initialized.
+     */
+    std::thread thread_;
+};
+
+#endif
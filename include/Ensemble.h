@@ -0,0 +1,109 @@
+#ifndef _ENSEMBLE_H_
+#define _ENSEMBLE_H_
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include "UniverseState.h"
+
+// Forward declarations.
+class ThreadPool;
+class Universe;
+
+/**
+ *  Summary statistics reported for each finished ensemble member.
+ */
+struct MemberSummary {
+    /**
+     *  Index of the member, in [0, members).
+     */
+    size_t member;
+
+    /**
+     *  Total (kinetic + potential) energy right after perturbation.
+     */
+    double initialEnergy;
+
+    /**
+     *  Total energy after the last step.
+     */
+    double finalEnergy;
+
+    /**
+     *  The bodies after the last step.
+     */
+    std::shared_ptr<const UniverseState> finalState;
+};
+
+/**
+ *  Runs many perturbed copies of a base scene concurrently. Every member gets
+ *  its own Universe built from clones of the scene's Objects, is handed to the
+ *  perturbation generator, and is then stepped to completion on one worker of
+ *  the provided ThreadPool. Running whole members per core needs no
+ *  synchronization during stepping and is the highest-throughput layout for
+ *  large ensembles of small systems.
+ */
+class Ensemble {
+public:
+    /**
+     *  Modifies the freshly cloned Universe of the given member. Called on a
+     *  worker thread, so it must not touch shared state without locking.
+     */
+    typedef std::function<void(size_t member, Universe &universe)> Perturbation;
+
+    /**
+     *  Receives the summary of each member as soon as it finishes. Calls are
+     *  serialized, but arrive in completion order rather than member order.
+     */
+    typedef std::function<void(const MemberSummary &summary)> SummarySink;
+
+    /**
+     *  Creates an ensemble of the bodies in scene. The scene is only read, and
+     *  must outlive every call to run().
+     */
+    Ensemble(const Universe &scene, const Perturbation &perturb);
+
+    /**
+     *  Steps members copies of the scene steps times by timeSec each, using
+     *  pool, and streams their summaries to sink. Returns once every member
+     *  has finished.
+     */
+    void run(size_t members, size_t steps, double timeSec, ThreadPool &pool,
+             const SummarySink &sink) const;
+
+    /**
+     *  Returns a perturbation that scales the velocity of every body except
+     *  the first (the "sun") by 1 + N(0, sigma) per component. Member m always
+     *  draws from the same random stream, so runs are reproducible.
+     */
+    static Perturbation velocityNoise(double sigma, unsigned long seed);
+
+    /**
+     *  Returns the total kinetic plus gravitational potential energy.
+     */
+    static double getEnergy(const Universe &universe);
+
+private:
+    /**
+     *  Creates, perturbs, and steps a single member.
+     */
+    void runMember(size_t member, size_t steps, double timeSec, const SummarySink &sink) const;
+
+    /**
+     *  The unperturbed scene.
+     */
+    const Universe &scene_;
+
+    /**
+     *  Perturbation applied to each member.
+     */
+    Perturbation perturb_;
+
+    /**
+     *  Serializes calls to the summary sink.
+     */
+    mutable std::mutex sinkMutex_;
+};
+
+#endif
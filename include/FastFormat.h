@@ -0,0 +1,125 @@
+#ifndef _FAST_FORMAT_H_
+#define _FAST_FORMAT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ *  Converts floating point numbers to the shortest decimal text that reads
+ *  back (e.g. with strtod) as exactly the same number, without iostreams or
+ *  heap allocation. Digits are generated with the Grisu2 algorithm (Loitsch,
+ *  "Printing Floating-Point Numbers Quickly and Accurately with Integers"),
+ *  which finds the shortest representation for the vast majority of inputs
+ *  and a correct, at most one digit longer, one otherwise.
+ *
+ *  Magnitudes from 1e-6 up to (excluding) 1e21 are written in fixed notation
+ *  (0.001, 149597870700), others in exponential notation (1.98892e+30,
+ *  5e-324). Negative zero is written as -0, infinities as inf
+ *  and -inf, and NaNs as nan.
+ */
+class FastFormat {
+public:
+    /**
+     *  Upper bound of the number of characters written by format.
+     */
+    static const size_t maxLength = 32;
+
+    /**
+     *  Writes value to buffer, which must have room for maxLength characters,
+     *  and returns a pointer one past the last character written. The text is
+     *  not null terminated.
+     */
+    static char * format(double value, char *buffer);
+
+    /**
+     *  Writes value to buffer using the shortest text that reads back as the
+     *  same float.
+     */
+    static char * format(float value, char *buffer);
+
+    /**
+     *  Writes value to buffer. Values that are exactly representable as
+     *  doubles are written as such; others with enough digits to read back
+     *  as the same long double.
+     */
+    static char * format(long double value, char *buffer);
+
+    /**
+     *  Appends the text of value to out.
+     */
+    template <typename T>
+    static void append(T value, std::string &out);
+
+private:
+
+    /**
+     *  A floating point number f * 2^e with a 64 bit significand.
+     */
+    struct DiyFp {
+        uint64_t f;
+        int e;
+    };
+
+    /**
+     *  Returns x * y rounded to the 64 most significant bits.
+     */
+    static DiyFp multiply(const DiyFp &x, const DiyFp &y);
+
+    /**
+     *  Returns x shifted such that the most significant bit of f is set.
+     */
+    static DiyFp normalize(DiyFp x);
+
+    /**
+     *  Returns the cached power of ten c = 10^-k such that the product with a
+     *  number of binary exponent e has an exponent in [-60, -32], and stores
+     *  k in decimalExponent.
+     */
+    static DiyFp cachedPower(int e, int &decimalExponent);
+
+    /**
+     *  Generates the shortest digits of the number whose significand is
+     *  significand * 2^e. lowerIsCloser is true for powers of two whose lower
+     *  neighbour is half as far away as the upper one. Stores the digits in
+     *  digits and returns their count; the value is digits * 10^exponent.
+     */
+    static int grisu2(uint64_t significand, int e, bool lowerIsCloser, char *digits, int &exponent);
+
+    /**
+     *  Generates digits of the scaled number w within the scaled rounding
+     *  interval [upper - delta, upper].
+     */
+    static int generateDigits(const DiyFp &w, const DiyFp &upper, uint64_t delta,
+                              char *digits, int &exponent);
+
+    /**
+     *  Moves the last digit towards w while the result stays within the
+     *  rounding interval.
+     */
+    static void roundWeed(char *digits, int length, uint64_t delta, uint64_t rest,
+                          uint64_t tenKappa, uint64_t distance);
+
+    /**
+     *  Writes digits * 10^exponent in fixed or exponential notation.
+     */
+    static char * layout(const char *digits, int length, int exponent, char *buffer);
+
+    /**
+     *  Writes zeros, infinities and NaNs. Returns nullptr if value is finite
+     *  and non-zero.
+     */
+    template <typename T>
+    static char * formatSpecial(T value, char *buffer);
+};
+
+/**
+ *  Appends the text of value to out.
+ */
+template <typename T>
+void FastFormat::append(T value, std::string &out){
+    char buffer[maxLength];
+    out.append(buffer, format(value, buffer));
+}
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef _MAPPED_FILE_H_
+#define _MAPPED_FILE_H_
+
+#include <cstddef>
+#include <vector>
+
+/**
+ *  Read-only view of a whole file. On POSIX systems the file is mapped into
+ *  memory, so opening even a huge file costs no copying and pages are read on
+ *  first access; elsewhere, or if the file cannot be mapped (e.g. a pipe), it
+ *  is read into a buffer instead. The contents are not null terminated.
+ */
+class MappedFile {
+public:
+    /**
+     *  How the contents will be accessed, so the system can read ahead or
+     *  not.
+     */
+    enum Access { sequential, random };
+
+    /**
+     *  Opens and maps filename. throws an std::runtime_error if the file
+     *  cannot be read.
+     */
+    explicit MappedFile(const char *filename, Access access = sequential);
+
+    /**
+     *  Unmaps the file.
+     */
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile & operator=(const MappedFile &) = delete;
+
+    /**
+     *  Returns the first byte of the file.
+     */
+    const char * begin() const;
+
+    /**
+     *  Returns one past the last byte of the file.
+     */
+    const char * end() const;
+
+    /**
+     *  Returns the size of the file in bytes.
+     */
+    size_t size() const;
+
+private:
+
+    /**
+     *  The mapping, or nullptr if the contents were read into buffer_.
+     */
+    void *mapping_;
+
+    /**
+     *  Size of the file in bytes.
+     */
+    size_t size_;
+
+    /**
+     *  The contents of the file if it could not be mapped.
+     */
+    std::vector<char> buffer_;
+};
+
+#endif
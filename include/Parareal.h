@@ -0,0 +1,94 @@
+#ifndef _PARAREAL_H_
+#define _PARAREAL_H_
+
+#include <cstddef>
+#include <vector>
+#include "Vector.h"
+
+// Forward declarations.
+class Object;
+class ThreadPool;
+class Universe;
+
+/**
+ *  Time-parallel integration of a Universe using the parareal algorithm. The
+ *  run is split into time slices. A cheap coarse propagator (stepSimulation
+ *  with a large time step) sweeps the slices serially to guess the state at
+ *  each slice boundary; the exact fine propagator (stepSimulation with the
+ *  requested time step) then refines every slice concurrently on a
+ *  ThreadPool, and the two are combined with the parareal correction
+ *
+ *      U[n+1] = G(U'[n]) + F(U[n]) - G(U[n])
+ *
+ *  until the slice boundaries stop moving. This lets few-body, long-horizon
+ *  runs use more cores than they have bodies. After k iterations the first k
+ *  slices are identical to a serial fine run, so at most one iteration per
+ *  slice is ever needed.
+ */
+class Parareal {
+public:
+    /**
+     *  Creates an integrator whose fine and coarse propagators advance with
+     *  fineStep and coarseStep seconds respectively. Iteration stops once
+     *  the largest change of any slice boundary position, relative to the
+     *  largest position, is below tolerance, or after maxIterations.
+     */
+    Parareal(double fineStep, double coarseStep, double tolerance, size_t maxIterations);
+
+    /**
+     *  Advances universe by duration seconds split into slices time slices
+     *  refined concurrently on pool. Each slice is rounded to a whole number
+     *  of fine (and coarse) steps. Returns the number of iterations taken.
+     *  throws an std::invalid_argument if slices is zero or either time step
+     *  is not positive and finite.
+     *
+     *  Intermediate steps are not visible: the state is published, if a
+     *  multiple of the publish interval was passed, and the observers are
+     *  notified at every slice boundary once the run has converged.
+     */
+    size_t integrate(Universe &universe, double duration, size_t slices, ThreadPool &pool) const;
+
+private:
+    /**
+     *  The positions and velocities of every body at a slice boundary.
+     */
+    struct State {
+        std::vector<vector2> positions;
+        std::vector<vector2> velocities;
+    };
+
+    /**
+     *  Returns the result of stepping state steps times by timeSec, using a
+     *  private Universe populated with clones of bodies that sums forces as
+     *  selected by summation.
+     */
+    static State propagate(const std::vector<Object*> &bodies, const State &state,
+                           size_t steps, double timeSec, Summation summation);
+
+    /**
+     *  Returns the largest difference between the positions of lhs and rhs.
+     */
+    static double distance(const State &lhs, const State &rhs);
+
+    /**
+     *  Time step of the fine propagator in seconds.
+     */
+    double fineStep_;
+
+    /**
+     *  Time step of the coarse propagator in seconds.
+     */
+    double coarseStep_;
+
+    /**
+     *  Relative change of the slice boundaries below which iteration stops.
+     */
+    double tolerance_;
+
+    /**
+     *  Upper bound on the number of iterations.
+     */
+    size_t maxIterations_;
+};
+
+#endif
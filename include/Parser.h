@@ -1,25 +1,186 @@
 #ifndef _PARSER_H_
 #define _PARSER_H_
 
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+// Forward declarations
+class Object;
+class ThreadPool;
+class Universe;
+
 /**
  *  Class responsible for loading in custom setup scripts and configuring the
  *  Universe appropriately.
+ *
+ *  A script holds one body per line, written as
+ *
+ *      {name, mass, [x y], [vx vy]}
+ *
+ *  Any of the characters in delims() as well as tabs separate the fields, so
+ *  the braces and brackets are only decoration; every non-blank line must
+ *  consist of exactly a name followed by five numbers. Bodies are registered
+ *  in the order in which they appear in the script, so the first line is the
+ *  sun.
+ *
+ *  Large scripts may be loaded in parallel: the text is split at line
+ *  boundaries into chunks that are parsed on the workers of a ThreadPool and
+ *  then registered in file order, so the result is identical to that of a
+ *  sequential load.
+ *
+ *  Scripts may also be streamed: they are read in fixed-size blocks and the
+ *  bodies of each block are registered as soon as it has been parsed.
  */
 class Parser {
 public:
+    /**
+     *  Receives the number of bodies registered and the number of bytes read
+     *  so far while a script is streamed.
+     */
+    typedef std::function<void(size_t bodies, size_t bytes)> Progress;
+
+    /**
+     *  Creates a Parser that configures the default instance of the Universe.
+     */
+    Parser();
+
+    /**
+     *  Creates a Parser that configures universe.
+     */
+    explicit Parser(Universe &universe);
+
     /**
      *  Loads the script file and configures the Universe. Consult the
-     *  assignment PDF for the syntax of the scripts.
+     *  assignment PDF for the syntax of the scripts. throws an
+     *  std::runtime_error naming the file and line if the file cannot be read
+     *  or is malformed, in which case no bodies are added to the Universe.
      */
     void loadFile(const char *filename);
 
+    /**
+     *  Loads a script that is already in memory. throws an std::runtime_error
+     *  naming the line if the script is malformed, in which case no bodies are
+     *  added to the Universe.
+     */
+    void loadText(const char *begin, const char *end);
+
+    /**
+     *  Loads the script file using the workers of pool and configures the
+     *  Universe exactly like loadFile(filename) would.
+     */
+    void loadFile(const char *filename, ThreadPool &pool);
+
+    /**
+     *  Loads a script that is already in memory using the workers of pool.
+     */
+    void loadText(const char *begin, const char *end, ThreadPool &pool);
+
+    /**
+     *  Reads the script file in blocks of blockSize bytes and registers the
+     *  bodies of every block with the Universe before reading the next one,
+     *  so that the memory used beyond the bodies themselves is bounded by the
+     *  block size (or the longest line, if that is longer). progress, if set,
+     *  is called after every block and may use the bodies registered so far.
+     *  throws an std::runtime_error naming the file and line if the file
+     *  cannot be read or is malformed, in which case the bodies of the lines
+     *  before the block containing the error remain registered.
+     */
+    void streamFile(const char *filename, const Progress &progress = Progress(),
+                    size_t blockSize = 1 << 20);
+
 private:
 
-    const char* delims() {
+    static const char* delims() {
         return "{}[], ";
     }
 
-    double getDouble();
+    /**
+     *  Lookup table of the characters that separate fields.
+     */
+    struct Delimiters {
+        Delimiters();
+
+        bool contains(char c) const {
+            return table_[static_cast<unsigned char>(c)];
+        }
+
+    private:
+        bool table_[256];
+    };
+
+    /**
+     *  Parses every line of [begin, end), the first of which is line number
+     *  firstLine of the script, and appends the bodies to objects. On error
+     *  the bodies created so far are deleted and objects is left empty.
+     */
+    static void parseLines(const char *begin, const char *end, size_t firstLine,
+                           std::vector<Object*> &objects);
+
+    /**
+     *  Parses [begin, end) in chunks of whole lines on the workers of pool
+     *  and appends the bodies to objects in file order. On error every body
+     *  is deleted and the error of the first malformed line is thrown.
+     */
+    static void parseChunks(const char *begin, const char *end, ThreadPool &pool,
+                            std::vector<Object*> &objects);
+
+    /**
+     *  Returns the number of newlines in [begin, end).
+     */
+    static size_t countLines(const char *begin, const char *end);
+
+    /**
+     *  Scripts smaller than this many bytes per worker are not worth
+     *  splitting.
+     */
+    static const size_t minChunkSize = 1 << 16;
+
+    /**
+     *  Returns true if c separates fields.
+     */
+    static bool isDelimiter(char c);
+
+    /**
+     *  Parses the fields of a single line, which must not contain a newline,
+     *  and appends the body, if any, to objects.
+     */
+    static void parseLine(const char *begin, const char *end, size_t line,
+                          std::vector<Object*> &objects);
+
+    /**
+     *  Returns the first character at or after begin that is not a delimiter.
+     */
+    static const char * skipDelimiters(const char *begin, const char *end);
+
+    /**
+     *  Returns the first delimiter at or after begin.
+     */
+    static const char * skipField(const char *begin, const char *end);
+
+    /**
+     *  Converts the number at the start of the field beginning at begin,
+     *  stores it in value and returns the end of the field. throws an
+     *  std::runtime_error mentioning line if the field is not a number.
+     */
+    static const char * getDouble(const char *begin, const char *end, size_t line,
+                                  double &value);
+
+    /**
+     *  Converts the fields getDouble cannot convert exactly by itself, such as
+     *  long significands, extreme exponents, inf and nan, with strtod.
+     */
+    static double getDoubleExactly(const char *begin, const char *end, size_t line);
+
+    /**
+     *  Returns the Universe to configure.
+     */
+    Universe & universe() const;
+
+    /**
+     *  The Universe to configure, or nullptr for the default instance.
+     */
+    Universe *universe_;
 };
 
 #endif
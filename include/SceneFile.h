@@ -0,0 +1,143 @@
+#ifndef _SCENE_FILE_H_
+#define _SCENE_FILE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "MappedFile.h"
+
+// Forward declaration
+class Universe;
+
+/**
+ *  A scene in the binary scene format, which can be loaded without parsing
+ *  any text. The file is mapped into memory and its columns are used in
+ *  place.
+ *
+ *  The byte order mark and the version are uint32_t, every other integer a
+ *  uint64_t and every real a double, all in the byte order of the machine
+ *  that wrote the file. The file holds, in order and aligned to 8 bytes:
+ *
+ *      header        magic "NBSCENE", byte order mark, version, body count,
+ *                    dimensions (2), size of the name data
+ *      name offsets  count + 1 offsets into the name data; name i spans
+ *                    [offset i, offset i + 1)
+ *      name data     the names, back to back and not null terminated
+ *      mass          count masses
+ *      position      one column of count values per dimension
+ *      velocity      one column of count values per dimension
+ *
+ *  Bodies are stored in the order of the Universe, so the first is the sun.
+ */
+class SceneFile {
+public:
+    /**
+     *  Version of the format written by write.
+     */
+    static const uint32_t version = 1;
+
+    /**
+     *  Maps filename and checks that it is a complete scene file. throws an
+     *  std::runtime_error if it cannot be read or is not a scene file of a
+     *  known version written on a machine of the same byte order.
+     */
+    explicit SceneFile(const char *filename);
+
+    /**
+     *  Writes the bodies of universe to filename. throws an
+     *  std::runtime_error if the file cannot be written.
+     */
+    static void write(const char *filename, const Universe &universe);
+
+    /**
+     *  Returns true if filename starts like a scene file, as opposed to a
+     *  text script.
+     */
+    static bool isSceneFile(const char *filename);
+
+    /**
+     *  Returns the number of bodies.
+     */
+    size_t size() const;
+
+    /**
+     *  Returns the name of body.
+     */
+    std::string getName(size_t body) const;
+
+    /**
+     *  Returns the masses of all bodies.
+     */
+    const double * masses() const;
+
+    /**
+     *  Returns component d of the positions of all bodies.
+     */
+    const double * positions(size_t d) const;
+
+    /**
+     *  Returns component d of the velocities of all bodies.
+     */
+    const double * velocities(size_t d) const;
+
+    /**
+     *  Registers a new Object for every body with universe, in order.
+     */
+    void addTo(Universe &universe) const;
+
+private:
+
+    /**
+     *  The start of every scene file.
+     */
+    struct Header {
+        char magic[8];
+        uint32_t byteOrder;
+        uint32_t version;
+        uint64_t count;
+        uint64_t dimensions;
+        uint64_t namesSize;
+    };
+
+    /**
+     *  Offsets of the sections following the header, in bytes from the start
+     *  of the file.
+     */
+    struct Layout {
+        Layout(uint64_t count, uint64_t namesSize);
+
+        uint64_t nameOffsets;
+        uint64_t names;
+        uint64_t masses;
+        uint64_t positions;
+        uint64_t velocities;
+        uint64_t end;
+    };
+
+    /**
+     *  Returns header with the magic, byte order mark and version filled in.
+     */
+    static Header makeHeader();
+
+    /**
+     *  Returns the column of count doubles starting at offset.
+     */
+    const double * column(uint64_t offset) const;
+
+    /**
+     *  The mapped file.
+     */
+    MappedFile file_;
+
+    /**
+     *  The number of bodies.
+     */
+    size_t count_;
+
+    /**
+     *  Where the sections are.
+     */
+    Layout layout_;
+};
+
+#endif
@@ -0,0 +1,162 @@
+#ifndef _THREAD_POOL_H_
+#define _THREAD_POOL_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+/**
+ *  A fixed-size pool of worker threads that runs submitted tasks in FIFO
+ *  order. A single pool is meant to be shared by everything that needs
+ *  parallelism (ensembles, parareal slices, the parser) so that the process
+ *  never oversubscribes its cores. Clients that share it submit their tasks
+ *  through a Batch, so that they wait only for their own work.
+ */
+class ThreadPool {
+public:
+    /**
+     *  A group of tasks submitted to a pool that can be waited for on its
+     *  own, without waiting for the other tasks of the pool.
+     */
+    class Batch {
+    public:
+        /**
+         *  Creates an empty batch of tasks for pool.
+         */
+        explicit Batch(ThreadPool &pool);
+
+        /**
+         *  Waits for the tasks of the batch, discarding their exceptions.
+         */
+        ~Batch();
+
+        /**
+         *  Tasks refer to their batch, so batches may not be copied.
+         */
+        Batch(const Batch &) = delete;
+        Batch & operator=(const Batch &) = delete;
+
+        /**
+         *  Queues task on the pool as part of this batch.
+         */
+        void submit(const std::function<void()> &task);
+
+        /**
+         *  Blocks until every task of the batch has finished, running queued
+         *  tasks of the pool meanwhile so that it may be called from a task
+         *  of the same pool. If any task of the batch threw, the first such
+         *  exception is rethrown here.
+         */
+        void wait();
+
+    private:
+        /**
+         *  The pool the tasks run on.
+         */
+        ThreadPool &pool_;
+
+        /**
+         *  Number of tasks of the batch that have not finished, guarded by
+         *  the mutex of the pool.
+         */
+        size_t pending_;
+
+        /**
+         *  First exception thrown by a task of the batch since the last
+         *  wait(), guarded by the mutex of the pool.
+         */
+        std::exception_ptr error_;
+    };
+
+    /**
+     *  Starts threads workers. Zero selects one worker per hardware thread.
+     */
+    explicit ThreadPool(size_t threads = 0);
+
+    /**
+     *  Finishes every queued task and joins the workers.
+     */
+    ~ThreadPool();
+
+    /**
+     *  Pools own their threads, so they may not be copied.
+     */
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool & operator=(const ThreadPool &) = delete;
+
+    /**
+     *  Queues task for execution on one of the workers.
+     */
+    void submit(const std::function<void()> &task);
+
+    /**
+     *  Blocks until every submitted task, including those of other clients,
+     *  has finished. If any task submitted outside a Batch threw, the first
+     *  such exception is rethrown here. Must not be called from a task.
+     */
+    void wait();
+
+    /**
+     *  Returns the number of worker threads.
+     */
+    size_t size() const;
+
+private:
+    /**
+     *  Body of each worker thread.
+     */
+    void work();
+
+    /**
+     *  Takes the first queued task and runs it with lock released. lock must
+     *  hold mutex_ and the queue must not be empty.
+     */
+    void runNext(std::unique_lock<std::mutex> &lock);
+
+    /**
+     *  Worker threads.
+     */
+    std::vector<std::thread> workers_;
+
+    /**
+     *  Tasks waiting for a worker.
+     */
+    std::queue<std::function<void()> > tasks_;
+
+    /**
+     *  Guards every member below.
+     */
+    std::mutex mutex_;
+
+    /**
+     *  Signalled when a task is queued or the pool is stopping.
+     */
+    std::condition_variable available_;
+
+    /**
+     *  Signalled when the pool runs out of work or a batch finishes.
+     */
+    std::condition_variable idle_;
+
+    /**
+     *  Number of tasks currently executing.
+     */
+    size_t active_;
+
+    /**
+     *  Set by the destructor to release the workers.
+     */
+    bool stopping_;
+
+    /**
+     *  First exception thrown by a task since the last wait().
+     */
+    std::exception_ptr error_;
+};
+
+#endif
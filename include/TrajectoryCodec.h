@@ -0,0 +1,128 @@
+#ifndef _TRAJECTORY_CODEC_H_
+#define _TRAJECTORY_CODEC_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ *  Lossless compression of the columns of a trajectory chunk, in the spirit
+ *  of FPC (Burtscher and Ratanaworabhan, "High Throughput Compression of
+ *  Double-Precision Floating-Point Data") and Gorilla.
+ *
+ *  Each column is a stream of 64 bit words: the steps as integers, and the
+ *  times and quantities as the bit patterns of their doubles. Within one sign
+ *  and binade the bit pattern of a double grows linearly with its value, so a
+ *  smooth column is predicted well by extrapolating the previous words with a
+ *  polynomial of order 0 to 7. The encoder picks the order that yields the
+ *  fewest bytes for the column and stores, per word, the zigzag coded
+ *  difference to the prediction with its leading zero bytes removed. Two 4
+ *  bit byte counts share a header byte in front of the two residuals, so a
+ *  perfectly predicted word costs half a byte. Every bit pattern, including
+ *  NaNs, infinities and negative zeros, is reproduced exactly.
+ *
+ *  A stream is one byte with the order followed by the header bytes and
+ *  residuals. A compressed chunk payload holds the byte offsets of its
+ *  streams (2 + columns + 1 uint64_t, relative to the end of the offsets),
+ *  then the streams, padded to 8 bytes: stream 0 holds the steps, stream 1
+ *  the times and stream 2 + k column k. Any single column can therefore be
+ *  decoded without the others.
+ */
+class TrajectoryCodec {
+public:
+    /**
+     *  Highest order of the extrapolating polynomials.
+     */
+    static const unsigned maxOrder = 7;
+
+    /**
+     *  Appends the encoded count words of values to out.
+     */
+    static void encode(const uint64_t *values, size_t count, std::vector<char> &out);
+
+    /**
+     *  Appends the encoded bit patterns of count doubles to out.
+     */
+    static void encode(const double *values, size_t count, std::vector<char> &out);
+
+    /**
+     *  Decodes count words from the stream in [begin, end) into values and
+     *  returns the end of the stream. throws an std::runtime_error if the
+     *  stream is corrupt.
+     */
+    static const char * decode(const char *begin, const char *end, size_t count, uint64_t *values);
+
+    /**
+     *  Decodes count doubles from the stream in [begin, end) into values and
+     *  returns the end of the stream. throws an std::runtime_error if the
+     *  stream is corrupt.
+     */
+    static const char * decode(const char *begin, const char *end, size_t count, double *values);
+
+    /**
+     *  Replaces payload with the compressed payload of a chunk of count
+     *  samples: the steps, the times and columns columns of count values that
+     *  follow each other in values.
+     */
+    static void encodeChunk(size_t count, size_t columns, const uint64_t *steps, const double *times,
+                            const double *values, std::vector<char> &payload);
+
+    /**
+     *  Decodes the steps (stream 0) of the compressed payload of size bytes
+     *  of a chunk of count samples and columns columns. throws an
+     *  std::runtime_error if the payload is corrupt.
+     */
+    static void decodeStream(const char *payload, size_t size, size_t count, size_t columns,
+                             size_t stream, uint64_t *values);
+
+    /**
+     *  Decodes the times (stream 1) or column stream - 2 of the compressed
+     *  payload of size bytes of a chunk of count samples and columns columns.
+     *  throws an std::runtime_error if the payload is corrupt.
+     */
+    static void decodeStream(const char *payload, size_t size, size_t count, size_t columns,
+                             size_t stream, double *values);
+
+    /**
+     *  Decodes a whole compressed payload into the layout of a raw one: count
+     *  steps, count times and then columns columns of count values.
+     */
+    static void decodeChunk(const char *payload, size_t size, size_t count, size_t columns,
+                            uint64_t *steps, double *times, double *values);
+
+private:
+
+    /**
+     *  Appends the encoded bit patterns of count words of type T.
+     */
+    template <typename T>
+    static void encodeWords(const T *values, size_t count, std::vector<char> &out);
+
+    /**
+     *  Decodes count words into the bit patterns of values of type T.
+     */
+    template <typename T>
+    static const char * decodeWords(const char *begin, const char *end, size_t count, T *values);
+
+    /**
+     *  Decodes stream of a compressed payload into values of type T.
+     */
+    template <typename T>
+    static void decodeStreamWords(const char *payload, size_t size, size_t count, size_t columns,
+                                  size_t stream, T *values);
+
+    /**
+     *  Returns the prediction of order for the word at next from the order
+     *  words before it.
+     */
+    template <typename T>
+    static uint64_t predict(unsigned order, const T *next);
+
+    /**
+     *  Returns the number of bytes of the zigzag coded difference without its
+     *  leading zero bytes.
+     */
+    static unsigned residualBytes(uint64_t difference);
+};
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef _TRAJECTORY_INTERPOLATOR_H_
+#define _TRAJECTORY_INTERPOLATOR_H_
+
+#include <cstddef>
+#include <vector>
+#include "TrajectoryReader.h"
+#include "Vector.h"
+
+/**
+ *  Answers queries for the state of bodies at any time between the samples
+ *  of a trajectory file, so that trajectories can be recorded sparsely.
+ *
+ *  Between two samples at t0 and t1 = t0 + h, the position is the cubic
+ *  Hermite interpolant of the positions and velocities of both samples. Its
+ *  derivative gives the velocity. With s = (t - t0) / h, the error of the
+ *  position is
+ *
+ *      |p(t) - H(t)| = |p''''(xi)| / 24 * s^2 (1 - s)^2 * h^4
+ *
+ *  for some xi in [t0, t1]. The fourth derivative is estimated from how much
+ *  the (constant) third derivative of the interpolant changes from this
+ *  interval to each neighbouring one, and the larger estimate is used. The
+ *  error is therefore an estimate rather than a strict bound. It is exact
+ *  (zero) at the samples, and unknown (infinite) for a trajectory of only two
+ *  samples.
+ *
+ *  The samples around the last query are kept, so queries at increasing
+ *  times within an interval only read the file when they cross a sample.
+ */
+class TrajectoryInterpolator {
+public:
+    /**
+     *  The interpolated state of one body.
+     */
+    struct State {
+        vector2 position;
+        vector2 velocity;
+
+        /**
+         *  Estimated bound of the distance of position from the true
+         *  position.
+         */
+        double error;
+    };
+
+    /**
+     *  Interpolates the trajectory of reader, which must outlive the
+     *  interpolator.
+     */
+    explicit TrajectoryInterpolator(const TrajectoryReader &reader);
+
+    /**
+     *  Replaces states with the states of bodies at time. throws an
+     *  std::invalid_argument if time lies outside the recorded samples or a
+     *  body does not exist.
+     */
+    void interpolate(double time, const std::vector<size_t> &bodies, std::vector<State> &states);
+
+private:
+
+    /**
+     *  Reads the samples around the interval from sample to sample + 1 of
+     *  bodies, unless they are loaded already.
+     */
+    void load(size_t sample, const std::vector<size_t> &bodies);
+
+    /**
+     *  Returns the position or velocity (offset 0 or 2) of body b at sample
+     *  of the loaded window.
+     */
+    vector2 get(size_t sample, size_t b, size_t offset) const;
+
+    /**
+     *  Returns the third derivative of the interpolant of body b on the
+     *  interval from sample to sample + 1 of the loaded window.
+     */
+    vector2 thirdDerivative(size_t sample, size_t b) const;
+
+    /**
+     *  The trajectory.
+     */
+    const TrajectoryReader *reader_;
+
+    /**
+     *  The interval of the loaded window, whose samples are its neighbours
+     *  where they exist.
+     */
+    size_t interval_;
+
+    /**
+     *  The loaded samples, or an empty window.
+     */
+    TrajectoryReader::Window window_;
+};
+
+#endif
@@ -0,0 +1,232 @@
+#ifndef _TRAJECTORY_READER_H_
+#define _TRAJECTORY_READER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+
+/**
+ *  Random access to a trajectory file written by a TrajectoryRecorder.
+ *
+ *  The file is mapped into memory. Opening it reads the header, the names
+ *  and the index of chunks; the header of a chunk is only checked once the
+ *  chunk is read. Files without an index, such as recordings that were
+ *  never closed or whose index was cut short, are indexed by following the
+ *  chunk headers instead, up to the first chunk that was not completely
+ *  written. Reading a window of
+ *  samples for some bodies then touches only the chunks that overlap the
+ *  window, and within them only the columns of those bodies, so the cost
+ *  does not depend on the size of the file.
+ *
+ *  Samples are numbered from 0 in the order they were recorded; their steps
+ *  and times are expected to increase.
+ */
+class TrajectoryReader {
+public:
+    /**
+     *  The samples first to first + size() - 1 of some bodies.
+     */
+    struct Window {
+        /**
+         *  First sample of the window.
+         */
+        size_t first;
+
+        /**
+         *  The bodies in the window.
+         */
+        std::vector<size_t> bodies;
+
+        /**
+         *  Step and time of each sample.
+         */
+        std::vector<uint64_t> steps;
+        std::vector<double> times;
+
+        /**
+         *  Quantity q (x, y, vx, vy) of bodies[b] at sample first + s is
+         *  values[(s * bodies.size() + b) * TrajectoryRecorder::quantities + q].
+         */
+        std::vector<double> values;
+
+        /**
+         *  Returns the number of samples.
+         */
+        size_t size() const;
+    };
+
+    /**
+     *  Opens filename. throws an std::runtime_error if it cannot be read or
+     *  is not a valid trajectory file.
+     */
+    explicit TrajectoryReader(const char *filename);
+
+    /**
+     *  Readers own their mapping, so they may not be copied.
+     */
+    TrajectoryReader(const TrajectoryReader &) = delete;
+    TrajectoryReader & operator=(const TrajectoryReader &) = delete;
+
+    /**
+     *  Returns the number of bodies.
+     */
+    size_t getBodyCount() const;
+
+    /**
+     *  Returns the name of body.
+     */
+    std::string getName(size_t body) const;
+
+    /**
+     *  Returns the first body called name. throws an std::invalid_argument
+     *  if there is none.
+     */
+    size_t findBody(const std::string &name) const;
+
+    /**
+     *  Returns the number of samples.
+     */
+    size_t getSampleCount() const;
+
+    /**
+     *  Returns the number of steps between samples the recorder was asked for.
+     */
+    size_t getInterval() const;
+
+    /**
+     *  Returns the number of chunks.
+     */
+    size_t getChunkCount() const;
+
+    /**
+     *  Returns true if the chunks were located by the index of the file
+     *  rather than by following their headers.
+     */
+    bool isIndexed() const;
+
+    /**
+     *  Returns the step of sample.
+     */
+    uint64_t getStep(size_t sample) const;
+
+    /**
+     *  Returns the time of sample.
+     */
+    double getTime(size_t sample) const;
+
+    /**
+     *  Returns the first sample at or after time, or getSampleCount() if
+     *  there is none. The samples at times in [begin, end) are therefore
+     *  findSample(begin) to findSample(end) - 1.
+     */
+    size_t findSample(double time) const;
+
+    /**
+     *  Replaces window with the count samples from first on of bodies.
+     *  throws an std::invalid_argument if a sample or body does not exist,
+     *  and an std::runtime_error if a chunk is corrupt.
+     */
+    void read(size_t first, size_t count, const std::vector<size_t> &bodies, Window &window) const;
+
+private:
+
+    /**
+     *  A located chunk.
+     */
+    struct Chunk {
+        const char *payload;
+        uint64_t size;
+        uint64_t firstSample;
+        uint64_t sampleCount;
+        double firstTime;
+        double lastTime;
+    };
+
+    /**
+     *  Locates the chunks from the index at the end of the file, without
+     *  touching the chunks themselves. Returns false if the file has no
+     *  index.
+     */
+    bool readIndex(const char *begin, const char *end);
+
+    /**
+     *  Locates the chunks from begin to end by following their headers. An
+     *  incomplete last chunk or a partly written index is left out.
+     */
+    void scanChunks(const char *begin, const char *end);
+
+    /**
+     *  Returns true if the bytes from begin to end, which follow the chunks
+     *  located so far, can be the start of their index.
+     */
+    bool isPartialIndex(const char *begin, const char *end) const;
+
+    /**
+     *  Checks the chunk header at chunk and appends the chunk, which must end
+     *  before end. Returns the end of the chunk.
+     */
+    const char * addChunk(const char *chunk, const char *end);
+
+    /**
+     *  Returns true if a payload of size bytes can hold sampleCount samples
+     *  and fits in available bytes.
+     */
+    static bool isValidSize(uint64_t size, uint64_t sampleCount, size_t available);
+
+    /**
+     *  Checks that the header in front of the payload of chunk matches the
+     *  chunk and returns the encoding of the payload. throws an
+     *  std::runtime_error otherwise.
+     */
+    uint32_t checkChunk(const Chunk &chunk) const;
+
+    /**
+     *  Returns the chunk that holds sample.
+     */
+    const Chunk & findChunk(size_t sample) const;
+
+    /**
+     *  Copies count values of stream (0 for the steps, 1 for the times,
+     *  2 + k for column k) of chunk, starting at its sample first, to values
+     *  with the given stride.
+     */
+    template <typename T>
+    void readStream(const Chunk &chunk, size_t stream, size_t first, size_t count, T *values,
+                    size_t stride) const;
+
+    /**
+     *  Name of the file, for error messages.
+     */
+    std::string filename_;
+
+    /**
+     *  The contents of the file.
+     */
+    MappedFile file_;
+
+    /**
+     *  Number of bodies and steps between samples.
+     */
+    size_t bodyCount_;
+    size_t interval_;
+
+    /**
+     *  Offsets of the names of the bodies in names_.
+     */
+    std::vector<uint64_t> nameOffsets_;
+    std::string names_;
+
+    /**
+     *  The chunks in file order.
+     */
+    std::vector<Chunk> chunks_;
+
+    /**
+     *  Whether chunks_ came from the index.
+     */
+    bool indexed_;
+};
+
+#endif
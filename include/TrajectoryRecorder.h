@@ -0,0 +1,331 @@
+#ifndef _TRAJECTORY_RECORDER_H_
+#define _TRAJECTORY_RECORDER_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "UniverseObserver.h"
+
+// Forward declaration
+class Universe;
+
+/**
+ *  Records the positions and velocities of every body of a Universe to a
+ *  binary trajectory file while the simulation runs.
+ *
+ *  The recorder attaches itself to the Universe and takes a sample every
+ *  interval steps. Sampling copies the state of the bodies straight into a
+ *  preallocated slot of a bounded ring buffer; a dedicated writer thread
+ *  drains the ring, so disk I/O never blocks the simulation unless the ring
+ *  is full.
+ *
+ *  The byte order mark, the version and the chunk encoding are uint32_t,
+ *  every other integer a uint64_t and every real a double, all in the byte
+ *  order of the machine that wrote the file. The file holds, aligned to 8
+ *  bytes:
+ *
+ *      header        magic "NBTRAJ", byte order mark, version, body count,
+ *                    size of the name data, sample interval in steps
+ *      name offsets  body count + 1 offsets into the name data
+ *      name data     the names, back to back, padded to 8 bytes
+ *      chunks        any number of chunks of consecutive samples
+ *      index         one IndexEntry per chunk, then an IndexTrailer
+ *
+ *  Each chunk starts with a ChunkHeader (magic "CHNK", encoding, sample
+ *  count n, payload size in bytes) followed by the payload: the n steps, the
+ *  n times, and then one column per quantity (x, y, vx, vy) and body holding
+ *  its n samples, quantity-major. Reading a single body therefore touches one
+ *  contiguous run per quantity and chunk. Compressed chunks hold the same
+ *  columns in the layout of TrajectoryCodec.
+ *
+ *  The index is written by close(). It locates every chunk, its size and the
+ *  steps and times it covers, so a reader can seek to any sample without
+ *  touching the chunks in between. A recording that was never closed has no index, but
+ *  its chunks can still be found by following their headers.
+ */
+class TrajectoryRecorder : public UniverseObserver {
+public:
+    /**
+     *  Version of the format written by the recorder.
+     */
+    static const uint32_t version = 2;
+
+    /**
+     *  Number of recorded quantities per body: x, y, vx and vy.
+     */
+    static const size_t quantities = 4;
+
+    /**
+     *  Encodings of the chunk payload: raw columns as described above, or
+     *  columns compressed by TrajectoryCodec.
+     */
+    enum Encoding { raw = 0, predictive = 1 };
+
+    /**
+     *  Creates filename and attaches to universe, which must outlive the
+     *  recorder or be detached from it by close(). A sample is recorded after
+     *  every interval steps. Up to bufferedSamples samples wait for the
+     *  writer, and chunks hold about chunkBytes bytes of uncompressed
+     *  samples, written in encoding. throws an std::runtime_error if filename
+     *  cannot be created.
+     */
+    TrajectoryRecorder(Universe &universe, const char *filename, size_t interval = 1,
+                       size_t bufferedSamples = 8, size_t chunkBytes = 1 << 24,
+                       Encoding encoding = raw);
+
+    /**
+     *  Closes the recorder. Errors are ignored; call close() to see them.
+     */
+    ~TrajectoryRecorder();
+
+    /**
+     *  Recorders own a thread and a file, so they may not be copied.
+     */
+    TrajectoryRecorder(const TrajectoryRecorder &) = delete;
+    TrajectoryRecorder & operator=(const TrajectoryRecorder &) = delete;
+
+    /**
+     *  Records a sample if the step count of universe is a multiple of the
+     *  interval.
+     */
+    virtual void stepped(const Universe &universe);
+
+    /**
+     *  Records a sample of universe now, e.g. the initial state. Blocks while
+     *  the ring buffer is full. throws an std::runtime_error if the writer
+     *  failed, and an std::invalid_argument if the number of bodies changed
+     *  since the first sample.
+     */
+    void record(const Universe &universe);
+
+    /**
+     *  Detaches from the Universe, writes every buffered sample, and closes
+     *  the file. throws an std::runtime_error if anything could not be
+     *  written. Later calls do nothing.
+     */
+    void close();
+
+    /**
+     *  Returns the number of samples recorded so far.
+     */
+    size_t getSampleCount() const;
+
+    /**
+     *  The start of a trajectory file.
+     */
+    struct FileHeader {
+        char magic[8];
+        uint32_t byteOrder;
+        uint32_t version;
+        uint64_t bodyCount;
+        uint64_t namesSize;
+        uint64_t interval;
+    };
+
+    /**
+     *  The start of each chunk.
+     */
+    struct ChunkHeader {
+        char magic[4];
+        uint32_t encoding;
+        uint64_t sampleCount;
+        uint64_t size;
+    };
+
+    /**
+     *  Locates one chunk: its offset in the file, its number of samples, the
+     *  size of its payload in bytes, and the steps and times of its first
+     *  and last sample.
+     */
+    struct IndexEntry {
+        uint64_t offset;
+        uint64_t sampleCount;
+        uint64_t size;
+        uint64_t firstStep;
+        uint64_t lastStep;
+        double firstTime;
+        double lastTime;
+    };
+
+    /**
+     *  The end of the file: magic "NBTRIDX" and the number of index entries
+     *  in front of it.
+     */
+    struct IndexTrailer {
+        char magic[8];
+        uint64_t entryCount;
+    };
+
+    /**
+     *  Returns an index trailer with the magic filled in.
+     */
+    static IndexTrailer makeIndexTrailer();
+
+    /**
+     *  Returns a file header with the magic, byte order mark and version
+     *  filled in.
+     */
+    static FileHeader makeFileHeader();
+
+    /**
+     *  Returns the number of zero bytes that align size bytes to 8.
+     */
+    static size_t padding(size_t size);
+
+private:
+
+    /**
+     *  One buffered sample: the quantities of every body, quantity-major.
+     */
+    struct Sample {
+        uint64_t step;
+        double time;
+        std::vector<double> values;
+    };
+
+    /**
+     *  Body of the writer thread.
+     */
+    void work();
+
+    /**
+     *  Appends sample to the chunk being assembled.
+     */
+    void append(const Sample &sample);
+
+    /**
+     *  Writes the file header and the names of universe.
+     */
+    void writeHeader(const Universe &universe);
+
+    /**
+     *  Writes the assembled chunk and starts a new one.
+     */
+    void writeChunk();
+
+    /**
+     *  Writes the index of the chunks written so far.
+     */
+    void writeIndex();
+
+    /**
+     *  Writes size bytes of data. throws an std::runtime_error on failure.
+     */
+    void write(const void *data, size_t size);
+
+    /**
+     *  Rethrows and clears the first error of the writer thread, if any. The
+     *  caller must hold mutex_.
+     */
+    void rethrowError();
+
+    /**
+     *  The Universe being recorded, or nullptr once closed.
+     */
+    Universe *universe_;
+
+    /**
+     *  Name of the file, for error messages.
+     */
+    std::string filename_;
+
+    /**
+     *  The trajectory file.
+     */
+    std::unique_ptr<std::FILE, int (*)(std::FILE *)> file_;
+
+    /**
+     *  Steps between samples.
+     */
+    size_t interval_;
+
+    /**
+     *  Number of bodies per sample, fixed by the first sample.
+     */
+    size_t bodyCount_;
+
+    /**
+     *  Samples per chunk, fixed by the first sample.
+     */
+    size_t chunkSamples_;
+
+    /**
+     *  Requested payload size of a chunk.
+     */
+    size_t chunkBytes_;
+
+    /**
+     *  Encoding of the chunk payloads.
+     */
+    Encoding encoding_;
+
+    /**
+     *  Number of samples recorded.
+     */
+    size_t samples_;
+
+    /**
+     *  Ring buffer of samples waiting for the writer. Slot head_ is filled
+     *  next; the count_ slots before it are waiting or being appended.
+     */
+    std::vector<Sample> ring_;
+    size_t head_;
+    size_t count_;
+
+    /**
+     *  The chunk being assembled by the writer thread: steps, times and
+     *  columns of chunkSamples_ entries each.
+     */
+    std::vector<uint64_t> chunkSteps_;
+    std::vector<double> chunkTimes_;
+    std::vector<double> chunkColumns_;
+
+    /**
+     *  The compressed payload of the chunk being written.
+     */
+    std::vector<char> payload_;
+
+    /**
+     *  Number of bytes written to the file.
+     */
+    uint64_t written_;
+
+    /**
+     *  Index entries of the chunks written.
+     */
+    std::vector<IndexEntry> index_;
+
+    /**
+     *  Set by close() to stop the writer thread once the ring is empty.
+     */
+    bool stopping_;
+
+    /**
+     *  First error of the writer thread.
+     */
+    std::exception_ptr error_;
+
+    /**
+     *  Guards the ring indices, stopping_ and error_.
+     */
+    std::mutex mutex_;
+
+    /**
+     *  Signalled whenever a slot is filled or freed, or stopping_ is set.
+     */
+    std::condition_variable changed_;
+
+    /**
+     *  The writer thread, started at the end of the constructor.
+     */
+    std::thread thread_;
+};
+
+#endif
@@ -1,16 +1,26 @@
 #ifndef _UNIVERSE_H_
 #define _UNIVERSE_H_
 
+#include <atomic>
+#include <memory>
 #include <vector>
 #include "Vector.h"
+#include "UniverseState.h"
 
 // Forward declaration
 class Object;
+class UniverseObserver;
 
 /**
- *  A singleton class representing the Universe. For this assignment, the first
- *  object added to the Universe will be considered unmovable and so its
- *  position should not be changed.
+ *  A class representing the Universe. For this assignment, the first object
+ *  added to the Universe will be considered unmovable and so its position
+ *  should not be changed.
+ *
+ *  instance() provides the default Universe used by the Parser and the test
+ *  drivers. Additional, fully independent Universes may be constructed
+ *  directly so that many simulations (e.g. the members of an ensemble) can run
+ *  side by side in one process. Universes share no mutable state, so distinct
+ *  instances may be stepped concurrently from different threads.
  *
  *  Krzysztof Zienkiewicz
  */
@@ -23,7 +33,7 @@ public:
     static constexpr double G = 6.67428e-11;
 
     /**
-     *  Returns the only instance of the Universe
+     *  Returns the default instance of the Universe, creating it on first use.
      */
     static Universe* instance();
 
@@ -35,16 +45,36 @@ public:
     static vector2 getForce(const Object &obj1, const Object &obj2);
 
     /**
-     *  Releases all the dynamic objects still registered with the Universe.
+     *  Creates an empty Universe that is independent of instance().
+     */
+    Universe();
+
+    /**
+     *  Releases all the dynamic objects still registered with the Universe. If
+     *  this is the default instance, the next call to instance() creates a new
+     *  one.
      */
     ~Universe();
 
+    /**
+     *  Universes own their Objects, so they may not be copied.
+     */
+    Universe(const Universe &) = delete;
+    Universe & operator=(const Universe &) = delete;
+
     /**
      *  Registers an Object with the universe. The Universe will clean up this
      *  object when it deems necessary.
      */
     void addObject(Object *ptr);
 
+    /**
+     *  Registers all Objects in the container with the universe, in order, and
+     *  clears the container. The Universe will clean up these objects when it
+     *  deems necessary.
+     */
+    void addObjects(std::vector<Object*> &objects);
+
     /**
      *  Returns the begin iterator to the actual Objects. The order of itetarion
      *  will be the same as that over getSnapshot()'s result as long as no new
@@ -93,11 +123,67 @@ public:
      */
     void swap(std::vector<Object*> &snapshot);
 
-private:
     /**
-     *  Private constructor. Ensures access control.
+     *  Returns the number of times stepSimulation has been called.
      */
-    Universe();
+    size_t getStepCount() const;
+
+    /**
+     *  Returns the simulated time in seconds, i.e. the sum of all time steps
+     *  taken so far.
+     */
+    double getTime() const;
+
+    /**
+     *  Publishes a new UniverseState after every interval steps. An interval
+     *  of zero (the default) disables automatic publishing.
+     */
+    void setPublishInterval(size_t interval);
+
+    /**
+     *  Selects how the forces on each body are summed. Compensated summation
+     *  keeps the pull of small bodies from being rounded away next to a
+     *  massive one, which permits larger time steps for the same accuracy.
+     *  Defaults to Summation::naive.
+     */
+    void setSummation(Summation summation);
+
+    /**
+     *  Returns how the forces on each body are summed.
+     */
+    Summation getSummation() const;
+
+    /**
+     *  Captures the current bodies into an immutable UniverseState and makes it
+     *  the version returned by getState(). Only the simulation thread may call
+     *  this method.
+     */
+    void publishState();
+
+    /**
+     *  Returns the most recently published state, or nullptr if nothing has
+     *  been published yet. Safe to call from any thread while the simulation
+     *  steps; the returned version stays valid for as long as the caller holds
+     *  on to it, regardless of how many newer versions are published. Readers
+     *  take no lock: pinning a version costs a few atomic operations and never
+     *  waits for publishState.
+     */
+    std::shared_ptr<const UniverseState> getState() const;
+
+    /**
+     *  Registers observer to be notified after every step. The Universe does
+     *  not own its observers; each must be removed before it is destroyed.
+     */
+    void addObserver(UniverseObserver *observer);
+
+    /**
+     *  Stops notifying observer.
+     */
+    void removeObserver(UniverseObserver *observer);
+
+private:
+    friend class Checkpoint;
+    friend class Parareal;
 
     /**
      *  Calls delete on each pointer and removes it from the container.
@@ -110,7 +196,66 @@ private:
     std::vector<Object*> objects_;
 
     /**
-     *  Static pointer that ensures only a single instance of this class exists.
+     *  Number of steps taken so far.
+     */
+    size_t steps_;
+
+    /**
+     *  Simulated time in seconds.
+     */
+    double time_;
+
+    /**
+     *  Number of steps between automatically published states. Zero disables
+     *  publishing.
+     */
+    size_t publishInterval_;
+
+    /**
+     *  How the forces on each body are summed.
+     */
+    Summation summation_;
+
+    /**
+     *  A published version and the number of readers copying it right now.
+     *  The writing flag is set in pins while publishState replaces it.
+     */
+    struct StateSlot {
+        std::shared_ptr<const UniverseState> state;
+        mutable std::atomic<unsigned> pins;
+    };
+
+    /**
+     *  Number of slots that published versions rotate through. A reader pins
+     *  a slot only while copying its pointer, so publishState finds a free
+     *  one unless this many readers are copying at the same instant.
+     */
+    static const size_t stateSlots = 8;
+
+    /**
+     *  Flag in StateSlot::pins marking a slot that is being replaced.
+     */
+    static const unsigned writing = 1u << 31;
+
+    /**
+     *  The published versions. std::atomic_load on a shared_ptr takes a lock
+     *  in libstdc++, so readers instead pin the slot named by current_ with
+     *  an atomic counter while they copy its pointer.
+     */
+    StateSlot states_[stateSlots];
+
+    /**
+     *  Index of the slot holding the latest published state.
+     */
+    std::atomic<size_t> current_;
+
+    /**
+     *  Observers notified after every step.
+     */
+    std::vector<UniverseObserver*> observers_;
+
+    /**
+     *  Static pointer to the default instance.
      */
     static Universe* instance_;
 };
@@ -0,0 +1,26 @@
+#ifndef _UNIVERSE_OBSERVER_H_
+#define _UNIVERSE_OBSERVER_H_
+
+// Forward declaration.
+class Universe;
+
+/**
+ *  Abstract base class for objects that follow a simulation, e.g. to record
+ *  it. Observers are registered with Universe::addObserver and are notified
+ *  on the simulation thread after every step.
+ */
+class UniverseObserver {
+public:
+    /**
+     *  Pure virtual destructor. A necessary no-op since this is a base class.
+     */
+    virtual ~UniverseObserver() =0;
+
+    /**
+     *  Called by universe after each step, once its bodies, step count and
+     *  time have been updated.
+     */
+    virtual void stepped(const Universe &universe) =0;
+};
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef _UNIVERSE_STATE_H_
+#define _UNIVERSE_STATE_H_
+
+#include <string>
+#include <vector>
+#include "Vector.h"
+
+// Forward declaration.
+class Object;
+
+/**
+ *  A read-only copy of every body in the Universe taken between two steps.
+ *  The Universe publishes these so that observer threads (renderers,
+ *  telemetry) can read positions while the simulation keeps stepping. Once
+ *  published a state is never modified, so any number of readers may hold on
+ *  to one without synchronizing with the simulation thread.
+ *
+ *  All containers are parallel: index i describes the same body in each.
+ */
+struct UniverseState {
+    /**
+     *  Copies the properties of the provided objects.
+     */
+    UniverseState(const std::vector<Object*> &objects, size_t step, double time);
+
+    /**
+     *  Returns the number of bodies captured in this state.
+     */
+    size_t size() const;
+
+    /**
+     *  Names of the bodies.
+     */
+    std::vector<std::string> names;
+
+    /**
+     *  Masses of the bodies in kilograms.
+     */
+    std::vector<double> masses;
+
+    /**
+     *  Position vectors of the bodies in meters.
+     */
+    std::vector<vector2> positions;
+
+    /**
+     *  Velocity vectors of the bodies in meters/second.
+     */
+    std::vector<vector2> velocities;
+
+    /**
+     *  Number of steps the Universe had taken when this state was captured.
+     */
+    size_t step;
+
+    /**
+     *  Simulated time in seconds when this state was captured.
+     */
+    double time;
+};
+
+#endif
@@ -3,28 +3,63 @@
 
 #include <string>
 #include <cstddef>
+#include "VectorExpression.h"
+#include "VectorHelpers.h"
+#include "VectorKernels.h"
+#include "FastFormat.h"
 
 /**
  *
- *  A class representing an n-dimensional vector of doubles (n >= 1). Common
- *  vector operations are implemented in a loop-free manner to encourage use of
- *  functors and STL algorithms.
+ *  A class representing an n-dimensional vector of scalars (n >= 1). The scalar
+ *  type T defaults to double. Common vector operations are implemented in a
+ *  loop-free manner to encourage use of functors and STL algorithms.
+ *
+ *  The arithmetic operators build expression templates (see
+ *  VectorExpression.h) that are evaluated in a single pass when assigned to a
+ *  Vector, so chained arithmetic creates no temporary Vectors.
+ *
+ *  Construction, arithmetic, dot, normSq and cross are constexpr, so constant
+ *  vectors (axes, initial conditions, lookup tables) can be built at compile
+ *  time. At run time the same operations use the SIMD kernels.
+ *
+ *  Vectors of different scalar types (e.g. float positions relative to a local
+ *  origin, long double reference runs) convert explicitly into one another, and
+ *  dotAs/normSqAs accumulate in a wider type when mixing precisions.
  *
  *  Since no dynamic memory is used, destructor, copy constructor, and an
  *  assignment operator are not necessary.
  */
-template <size_t DIM>
-class Vector {
+template <size_t DIM, typename T = double>
+class Vector : public VectorExpression<DIM, T, Vector<DIM, T> > {
 public:
     /**
      *  Creates the zero vector.
      */
-    Vector();
+    constexpr Vector();
 
     /**
      *  Creates a vector using the first DIM values starting at ptr.
      */
-    explicit Vector(const double *ptr);
+    constexpr explicit Vector(const T *ptr);
+
+    /**
+     *  Creates a vector by evaluating expr.
+     */
+    template <typename E>
+    constexpr Vector(const VectorExpression<DIM, T, E> &expr);
+
+    /**
+     *  Creates a vector by evaluating expr and converting each component from
+     *  U to T.
+     */
+    template <typename U, typename E>
+    constexpr explicit Vector(const VectorExpression<DIM, U, E> &expr);
+
+    /**
+     *  Evaluates expr into this vector and returns the result for chaining.
+     */
+    template <typename E>
+    constexpr Vector<DIM, T> & operator=(const VectorExpression<DIM, T, E> &expr);
 
     /***************************************************************************
     *                                                                          *
@@ -35,164 +70,232 @@ public:
     /**
      *  Returns the sum of this vector and rhs.
      */
-    const Vector<DIM> add(const Vector<DIM> &rhs) const;
+    constexpr const Vector<DIM, T> add(const Vector<DIM, T> &rhs) const;
 
     /**
      *  Returns the additive inverse of this vector.
      */
-    const Vector<DIM> invert() const;
+    constexpr const Vector<DIM, T> invert() const;
 
     /**
      *  Scales a copy of this vector by rhs and returns the result.
      */
-    const Vector<DIM> scale(const double &rhs) const;
+    constexpr const Vector<DIM, T> scale(const T &rhs) const;
+
+    /**
+     *  Returns this vector plus x scaled by a, computed in one pass with fused
+     *  multiply-adds where the hardware allows it.
+     */
+    constexpr const Vector<DIM, T> addScaled(const Vector<DIM, T> &x, const T &a) const;
+
+    /**
+     *  Increments this vector by x scaled by a (the BLAS axpy) in place and
+     *  returns the result for chaining. Fused where the hardware allows it.
+     */
+    constexpr Vector<DIM, T> & axpy(const T &a, const Vector<DIM, T> &x);
+
+    /**
+     *  Returns the dot (inner) product of this vector and rhs. The products are
+     *  accumulated with fused multiply-adds where the hardware allows it.
+     */
+    constexpr T dot(const Vector<DIM, T> &rhs) const;
 
     /**
-     *  Returns the dot (inner) product of this vector and rhs.
+     *  Returns the dot (inner) product of this vector and rhs, accumulating the
+     *  products as selected by summation.
      */
-    double dot(const Vector<DIM> &rhs) const;
+    T dot(const Vector<DIM, T> &rhs, Summation summation) const;
 
     /**
      *  Returns the square of the magnitude of this vector.
      */
-    double normSq() const;
+    constexpr T normSq() const;
 
     /**
      *  Returns the magnitude of this vector.
      */
-    double norm() const;
+    T norm() const;
+
+    /**
+     *  Returns 1 / norm(), computed as selected by precision (see
+     *  NormPrecision).
+     */
+    T inverseNorm(NormPrecision precision = NormPrecision::exact) const;
+
+    /**
+     *  Returns a copy of this vector scaled by inverseNorm(precision), i.e. of
+     *  magnitude 1.
+     */
+    const Vector<DIM, T> direction(NormPrecision precision = NormPrecision::exact) const;
+
+    /**
+     *  Returns a copy of this vector divided by the cube of its magnitude: its
+     *  direction scaled by the inverse square of its magnitude, the shape of
+     *  every inverse-square force. Takes a single inverseNorm(precision) and no
+     *  division.
+     */
+    const Vector<DIM, T> inverseSquare(NormPrecision precision = NormPrecision::exact) const;
 
     /**
      *  Scales this vector such that its magnitude is 1 and returns the result
      *  for chaining.
      */
-    Vector<DIM> & normalize();
+    Vector<DIM, T> & normalize();
 
     /**
      *  Returns the cross product of this and rhs if called on a 3D vector.
      *  throws an std::domain_error otherwise.
      */
-    const Vector<DIM> cross(const Vector<DIM> &v) const;
+    constexpr const Vector<DIM, T> cross(const Vector<DIM, T> &v) const;
 
     /**
-     *  Returns a human readable representation of this vector.
-     *  Ex. [1 2 3]
+     *  Returns a human readable representation of this vector. Each component
+     *  is written with the fewest digits that read back as the same value.
+     *  Ex. [1 2.5 1.98892e+30]
      */
     std::string toString() const;
 
-    /***************************************************************************
-    *                                                                          *
-    *                  O V E R L O A D E D   O P E R A T O R S                 *
-    *                                                                          *
-    ***************************************************************************/
-
     /**
-     *  Returns true if this vector equals rhs.
+     *  Upper bound of the number of characters written by appendTo(char *).
      */
-    bool operator==(const Vector<DIM> &rhs) const;
+    static const size_t maxStringLength = DIM * (FastFormat::maxLength + 1) + 1;
 
     /**
-     *  Returns true if this vector differs from rhs.
+     *  Writes the text of toString() to buffer, which must have room for
+     *  maxStringLength characters, and returns a pointer one past the last
+     *  character written. The text is not null terminated. Allocates no
+     *  memory.
      */
-    bool operator!=(const Vector<DIM> &rhs) const;
+    char * appendTo(char *buffer) const;
 
     /**
-     *  Returns a reference to the index-th component of this vector. Not range
-     *  checked.
+     *  Appends the text of toString() to out. Allocates no memory unless out
+     *  has to grow.
      */
-    double& operator[](size_t index);
+    void appendTo(std::string &out) const;
+
+    /***************************************************************************
+    *                                                                          *
+    *                  O V E R L O A D E D   O P E R A T O R S                 *
+    *                                                                          *
+    ***************************************************************************/
 
     /**
      *  Returns a reference to the index-th component of this vector. Not range
      *  checked.
      */
-    const double& operator[](size_t index) const;
+    constexpr T& operator[](size_t index);
 
     /**
-     *  Returns the sum of this vector and rhs.
+     *  Returns a reference to the index-th component of this vector. Not range
+     *  checked.
      */
-    Vector<DIM> operator+(const Vector<DIM> &rhs) const;
+    constexpr const T& operator[](size_t index) const;
 
     /**
      *  Increments this vector by rhs and returns the result for chaining.
      */
-    Vector<DIM> & operator+=(const Vector<DIM> &rhs);
+    constexpr Vector<DIM, T> & operator+=(const Vector<DIM, T> &rhs);
 
     /**
-     *  Returns the additive inverse of this vector.
+     *  Increments this vector by rhs and returns the result for chaining.
      */
-    Vector<DIM> operator-() const;
+    template <typename E>
+    constexpr Vector<DIM, T> & operator+=(const VectorExpression<DIM, T, E> &rhs);
 
     /**
-     *  Returns the difference between this vector and rhs.
+     *  Decrements this vector by rhs and returns the result for chaining.
      */
-    Vector<DIM> operator-(const Vector<DIM> &rhs) const;
+    constexpr Vector<DIM, T> & operator-=(const Vector<DIM, T> &v);
 
     /**
      *  Decrements this vector by rhs and returns the result for chaining.
      */
-    Vector<DIM> & operator-=(const Vector<DIM> &v);
+    template <typename E>
+    constexpr Vector<DIM, T> & operator-=(const VectorExpression<DIM, T, E> &v);
 
     /**
      *  Scales this vector by rhs and returns the result for chaining.
      */
-    Vector<DIM> & operator*=(const double &rhs);
+    constexpr Vector<DIM, T> & operator*=(const T &rhs);
 
     /**
      *  Scales this vector by 1.0 / rhs and returns the result for chaining.
      */
-    Vector<DIM> & operator/=(const double &rhs);
+    constexpr Vector<DIM, T> & operator/=(const T &rhs);
 
-    /**
-     *  Scales a copy of this vector by rhs and returns the result.
+    /*
+     *  ==, !=, +, -, * (scale and dot), / and ^ are free functions declared in
+     *  VectorExpression.h so that they accept any mix of Vectors and
+     *  expressions.
      */
-    Vector<DIM> operator*(const double &rhs) const;
-
-    /**
-     *  Scales a copy of this vector by 1.0 / rhs and returns the result.
-     */
-    Vector<DIM> operator/(const double &rhs) const;
-
-    /**
-     *  Returns the dot (inner) product of this vector and rhs.
-     */
-    double operator*(const Vector<DIM> &rhs) const;
-
-    /**
-     *  Returns the cross product of this and rhs if called on a 3D vector.
-     *  throws an std::domain_error otherwise.
-     */
-    Vector<DIM> operator^(const Vector<DIM> &v) const;
 
 private:
 
     /**
      *  Private iterator methods.
      */
-    double* begin();
+    T* begin();
 
-    const double* begin() const;
+    const T* begin() const;
 
-    double* end();
+    T* end();
 
-    const double* end() const;
+    const T* end() const;
 
     /**
      *  Statically allocated storage space.
      */
-    double data_[DIM];
+    T data_[DIM];
 };
 
 /**
- *  Returns the result of scaling a copy of v by scale. This free function
- *  guarantees that vector scaling is commutative.
+ *  Returns the dot (inner) product of lhs and rhs. Preferred over the
+ *  expression version when both operands are Vectors so that the SIMD kernels
+ *  are used.
  */
-template <size_t DIM>
-const Vector<DIM> operator*(const double &scale, const Vector<DIM> &v);
+template <size_t DIM, typename T>
+constexpr T operator*(const Vector<DIM, T> &lhs, const Vector<DIM, T> &rhs);
+
+/**
+ *  Compensated summation of vectors, component by component.
+ */
+template <size_t DIM, typename T>
+class CompensatedSum<Vector<DIM, T> > {
+public:
+    /**
+     *  Starts the sum at initial.
+     */
+    explicit CompensatedSum(const Vector<DIM, T> &initial = Vector<DIM, T>());
+
+    /**
+     *  Adds value and returns the sum for chaining.
+     */
+    CompensatedSum & operator+=(const Vector<DIM, T> &value);
+
+    /**
+     *  Returns the sum with the accumulated rounding errors added back.
+     */
+    Vector<DIM, T> sum() const;
+
+private:
+    /**
+     *  One compensated sum per component.
+     */
+    CompensatedSum<T> components_[DIM];
+};
 
 typedef Vector<2> vector2;
 typedef Vector<3> vector3;
 typedef Vector<4> vector4;
 
+typedef Vector<2, float> vector2f;
+typedef Vector<3, float> vector3f;
+typedef Vector<4, float> vector4f;
+
+typedef Vector<2, long double> vector2l;
+typedef Vector<3, long double> vector3l;
+typedef Vector<4, long double> vector4l;
+
 #include "../src/Vector.cpp"
 #endif
@@ -0,0 +1,169 @@
+#ifndef _VECTOR_ARRAY_H_
+#define _VECTOR_ARRAY_H_
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "Vector.h"
+
+/**
+ *  A resizable array of Vector<DIM, T> stored as structure of arrays: one
+ *  contiguous column per component. Bulk operations run one simple loop per
+ *  column, which the compiler vectorizes, instead of one Vector operation per
+ *  element. Use this when the same operation is applied to many vectors, e.g.
+ *  scaling every velocity or moving every position into the center of mass
+ *  frame.
+ *
+ *  Elements are read and written as Vectors by value; there are no references
+ *  to individual elements since their components are not adjacent in memory.
+ *  Operations combining two arrays throw an std::invalid_argument if their
+ *  sizes differ.
+ */
+template <size_t DIM, typename T = double>
+class VectorArray {
+public:
+    /**
+     *  Creates an array of count zero vectors.
+     */
+    explicit VectorArray(size_t count = 0);
+
+    /**
+     *  Returns the number of vectors in the array.
+     */
+    size_t size() const;
+
+    /**
+     *  Resizes the array to count vectors. New vectors are zero.
+     */
+    void resize(size_t count);
+
+    /**
+     *  Reserves storage for count vectors.
+     */
+    void reserve(size_t count);
+
+    /**
+     *  Appends v to the array.
+     */
+    void push_back(const Vector<DIM, T> &v);
+
+    /**
+     *  Returns the index-th vector. Not range checked.
+     */
+    Vector<DIM, T> operator[](size_t index) const;
+
+    /**
+     *  Overwrites the index-th vector with v. Not range checked.
+     */
+    void set(size_t index, const Vector<DIM, T> &v);
+
+    /**
+     *  Returns the contiguous column holding component d of every vector.
+     */
+    T * component(size_t d);
+
+    /**
+     *  Returns the contiguous column holding component d of every vector.
+     */
+    const T * component(size_t d) const;
+
+    /**
+     *  Adds offset to every vector.
+     */
+    VectorArray<DIM, T> & add(const Vector<DIM, T> &offset);
+
+    /**
+     *  Adds the vectors of rhs to the vectors of this array element-wise.
+     */
+    VectorArray<DIM, T> & add(const VectorArray<DIM, T> &rhs);
+
+    /**
+     *  Adds the vectors of x scaled by a to the vectors of this array
+     *  element-wise (the BLAS axpy).
+     */
+    VectorArray<DIM, T> & axpy(const T &a, const VectorArray<DIM, T> &x);
+
+    /**
+     *  Scales every vector by factor.
+     */
+    VectorArray<DIM, T> & scale(const T &factor);
+
+    /**
+     *  Scales every vector such that its magnitude is 1.
+     */
+    VectorArray<DIM, T> & normalize();
+
+    /**
+     *  Stores the square of the magnitude of every vector in out.
+     */
+    void normSq(std::vector<T> &out) const;
+
+    /**
+     *  Stores the magnitude of every vector in out.
+     */
+    void norm(std::vector<T> &out) const;
+
+    /**
+     *  Stores the dot product of every vector with the matching vector of rhs
+     *  in out.
+     */
+    void dot(const VectorArray<DIM, T> &rhs, std::vector<T> &out) const;
+
+    /**
+     *  Returns the sum of all vectors.
+     */
+    Vector<DIM, T> sum() const;
+
+    /**
+     *  Returns the sum of all vectors, each scaled by the matching weight,
+     *  e.g. masses for a center of mass.
+     */
+    Vector<DIM, T> sum(const std::vector<T> &weights) const;
+
+    /**
+     *  Returns the component-wise minimum of all vectors. throws an
+     *  std::domain_error if the array is empty.
+     */
+    Vector<DIM, T> min() const;
+
+    /**
+     *  Returns the component-wise maximum of all vectors. throws an
+     *  std::domain_error if the array is empty.
+     */
+    Vector<DIM, T> max() const;
+
+    /**
+     *  Returns the smallest axis-aligned box containing every vector as the
+     *  pair (min(), max()). throws an std::domain_error if the array is empty.
+     */
+    std::pair<Vector<DIM, T>, Vector<DIM, T> > boundingBox() const;
+
+private:
+
+    /**
+     *  Returns the sum of column, with every entry multiplied by the matching
+     *  weight unless weights is null.
+     */
+    T columnSum(const T *column, const T *weights) const;
+
+    /**
+     *  Returns the vector whose every component is the result of folding
+     *  pick (std::min or std::max) over that column. throws an
+     *  std::domain_error if the array is empty.
+     */
+    template <typename Pick>
+    Vector<DIM, T> extreme(Pick pick) const;
+
+    /**
+     *  throws an std::invalid_argument unless count matches size().
+     */
+    void checkSize(size_t count) const;
+
+    /**
+     *  One column per component.
+     */
+    std::vector<T> columns_[DIM];
+};
+
+#include "../src/VectorArray.cpp"
+#endif
@@ -0,0 +1,245 @@
+#ifndef _VECTOR_EXPRESSION_H_
+#define _VECTOR_EXPRESSION_H_
+
+#include <string>
+#include <cstddef>
+
+// Forward declaration.
+template <size_t DIM, typename T>
+class Vector;
+
+/**
+ *  Yields T unchanged. Wrapping a parameter type in it keeps that parameter
+ *  out of template argument deduction, so that e.g. 2 * v works for vectors
+ *  of any scalar type.
+ */
+template <typename T>
+struct VectorScalar {
+    typedef T type;
+};
+
+/**
+ *  Base class of every vector-valued expression (the Curiously Recurring
+ *  Template Pattern). Arithmetic operators on vectors do not compute anything;
+ *  they build a lightweight tree of expression nodes that is evaluated one
+ *  component at a time when it is assigned to a Vector. Chained expressions
+ *  such as a * (p1 - p2) + v therefore run in a single loop and produce no
+ *  intermediate Vectors.
+ *
+ *  T is the scalar type of every component. Operands of an expression must
+ *  share their scalar type; convert explicitly to mix precisions.
+ *
+ *  Expression nodes refer to the Vectors they were built from, so they must
+ *  be consumed within the full expression that creates them. Do not store
+ *  them with auto.
+ */
+template <size_t DIM, typename T, typename E>
+class VectorExpression {
+public:
+    /**
+     *  The scalar type of the components.
+     */
+    typedef T scalar_type;
+
+    /**
+     *  Returns the index-th component of the expression. Not range checked.
+     */
+    constexpr T operator[](size_t index) const;
+
+    /**
+     *  Returns the dot (inner) product of this expression and rhs.
+     */
+    template <typename R>
+    constexpr T dot(const VectorExpression<DIM, T, R> &rhs) const;
+
+    /**
+     *  Returns the square of the magnitude of this expression.
+     */
+    constexpr T normSq() const;
+
+    /**
+     *  Returns the magnitude of this expression.
+     */
+    T norm() const;
+
+    /**
+     *  Evaluates this expression and returns the result scaled such that its
+     *  magnitude is 1.
+     */
+    Vector<DIM, T> normalize() const;
+
+    /**
+     *  Returns a human readable representation of this expression.
+     *  Ex. [1 2 3]
+     */
+    std::string toString() const;
+
+    /**
+     *  Returns this expression as its concrete type.
+     */
+    constexpr const E & self() const;
+};
+
+/**
+ *  Selects how an expression node holds on to its operands: Vectors are held
+ *  by reference and other nodes, which are tiny, by value.
+ */
+template <typename E>
+struct VectorOperand {
+    typedef const E type;
+};
+
+template <size_t DIM, typename T>
+struct VectorOperand<Vector<DIM, T> > {
+    typedef const Vector<DIM, T> & type;
+};
+
+/**
+ *  Expression node for lhs + rhs.
+ */
+template <size_t DIM, typename T, typename L, typename R>
+class VectorSum : public VectorExpression<DIM, T, VectorSum<DIM, T, L, R> > {
+public:
+    constexpr VectorSum(const L &lhs, const R &rhs);
+
+    constexpr T operator[](size_t index) const;
+
+private:
+    typename VectorOperand<L>::type lhs_;
+    typename VectorOperand<R>::type rhs_;
+};
+
+/**
+ *  Expression node for lhs - rhs.
+ */
+template <size_t DIM, typename T, typename L, typename R>
+class VectorDifference : public VectorExpression<DIM, T, VectorDifference<DIM, T, L, R> > {
+public:
+    constexpr VectorDifference(const L &lhs, const R &rhs);
+
+    constexpr T operator[](size_t index) const;
+
+private:
+    typename VectorOperand<L>::type lhs_;
+    typename VectorOperand<R>::type rhs_;
+};
+
+/**
+ *  Expression node for -operand.
+ */
+template <size_t DIM, typename T, typename E>
+class VectorNegation : public VectorExpression<DIM, T, VectorNegation<DIM, T, E> > {
+public:
+    constexpr explicit VectorNegation(const E &operand);
+
+    constexpr T operator[](size_t index) const;
+
+private:
+    typename VectorOperand<E>::type operand_;
+};
+
+/**
+ *  Expression node for operand * factor.
+ */
+template <size_t DIM, typename T, typename E>
+class VectorScale : public VectorExpression<DIM, T, VectorScale<DIM, T, E> > {
+public:
+    constexpr VectorScale(const E &operand, T factor);
+
+    constexpr T operator[](size_t index) const;
+
+private:
+    typename VectorOperand<E>::type operand_;
+    T factor_;
+};
+
+/***************************************************************************
+*                                                                          *
+*                  O V E R L O A D E D   O P E R A T O R S                 *
+*                                                                          *
+***************************************************************************/
+
+/**
+ *  Returns true if lhs equals rhs.
+ */
+template <size_t DIM, typename T, typename L, typename R>
+constexpr bool operator==(const VectorExpression<DIM, T, L> &lhs, const VectorExpression<DIM, T, R> &rhs);
+
+/**
+ *  Returns true if lhs differs from rhs.
+ */
+template <size_t DIM, typename T, typename L, typename R>
+constexpr bool operator!=(const VectorExpression<DIM, T, L> &lhs, const VectorExpression<DIM, T, R> &rhs);
+
+/**
+ *  Returns the sum of lhs and rhs.
+ */
+template <size_t DIM, typename T, typename L, typename R>
+constexpr VectorSum<DIM, T, L, R> operator+(const VectorExpression<DIM, T, L> &lhs,
+                                            const VectorExpression<DIM, T, R> &rhs);
+
+/**
+ *  Returns the difference between lhs and rhs.
+ */
+template <size_t DIM, typename T, typename L, typename R>
+constexpr VectorDifference<DIM, T, L, R> operator-(const VectorExpression<DIM, T, L> &lhs,
+                                                   const VectorExpression<DIM, T, R> &rhs);
+
+/**
+ *  Returns the additive inverse of v.
+ */
+template <size_t DIM, typename T, typename E>
+constexpr VectorNegation<DIM, T, E> operator-(const VectorExpression<DIM, T, E> &v);
+
+/**
+ *  Returns v scaled by scale.
+ */
+template <size_t DIM, typename T, typename E>
+constexpr VectorScale<DIM, T, E> operator*(const VectorExpression<DIM, T, E> &v,
+                                           const typename VectorScalar<T>::type &scale);
+
+/**
+ *  Returns v scaled by scale. This free function guarantees that vector
+ *  scaling is commutative.
+ */
+template <size_t DIM, typename T, typename E>
+constexpr VectorScale<DIM, T, E> operator*(const typename VectorScalar<T>::type &scale,
+                                           const VectorExpression<DIM, T, E> &v);
+
+/**
+ *  Returns v scaled by 1.0 / scale.
+ */
+template <size_t DIM, typename T, typename E>
+constexpr VectorScale<DIM, T, E> operator/(const VectorExpression<DIM, T, E> &v,
+                                           const typename VectorScalar<T>::type &scale);
+
+/**
+ *  Returns the dot (inner) product of lhs and rhs.
+ */
+template <size_t DIM, typename T, typename L, typename R>
+constexpr T operator*(const VectorExpression<DIM, T, L> &lhs, const VectorExpression<DIM, T, R> &rhs);
+
+/**
+ *  Returns the cross product of lhs and rhs if called on 3D vectors.
+ *  throws an std::domain_error otherwise.
+ */
+template <size_t DIM, typename T, typename L, typename R>
+constexpr Vector<DIM, T> operator^(const VectorExpression<DIM, T, L> &lhs,
+                                   const VectorExpression<DIM, T, R> &rhs);
+
+/**
+ *  Returns the dot (inner) product of lhs and rhs accumulated in type A. The
+ *  operands may have different scalar types, e.g. two float vectors can be
+ *  multiplied and summed in double.
+ */
+template <typename A, size_t DIM, typename T, typename U, typename L, typename R>
+constexpr A dotAs(const VectorExpression<DIM, T, L> &lhs, const VectorExpression<DIM, U, R> &rhs);
+
+/**
+ *  Returns the square of the magnitude of v accumulated in type A.
+ */
+template <typename A, size_t DIM, typename T, typename E>
+constexpr A normSqAs(const VectorExpression<DIM, T, E> &v);
+
+#include "../src/VectorExpression.cpp"
+#endif
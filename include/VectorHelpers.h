@@ -3,25 +3,147 @@
 
 #include <functional>
 #include <iostream>
+#include <cmath>
 
 /**
- *  A simple binary functor that adds doubles and returns their sums.
+ *  A simple binary functor that adds scalars (doubles by default) and returns
+ *  their sums.
  */
-struct adder : std::binary_function<double, double, double> {
-    double operator()(const double &a, const double &b) const {
+template <typename T = double>
+struct adder : std::binary_function<T, T, T> {
+    T operator()(const T &a, const T &b) const {
         return a + b;
     }
 };
 
 /**
- *  A simple binary functor that multiplies doubles and returns their products.
+ *  A simple binary functor that multiplies scalars (doubles by default) and
+ *  returns their products.
  */
-struct multiplier : std::binary_function<double, double, double> {
-    double operator()(const double &a, const double &b) const {
+template <typename T = double>
+struct multiplier : std::binary_function<T, T, T> {
+    T operator()(const T &a, const T &b) const {
         return a * b;
     }
 };
 
+/**
+ *  Returns a * b + c. When the target has hardware fused multiply-add (the
+ *  FP_FAST_FMA macros from <cmath>) the result is rounded only once;
+ *  otherwise this is the plain expression, since a software fma is far slower
+ *  than the rounding error it saves.
+ */
+template <typename T>
+T fusedMultiplyAdd(const T &a, const T &b, const T &c) {
+    return a * b + c;
+}
+
+inline double fusedMultiplyAdd(const double &a, const double &b, const double &c) {
+#if defined(FP_FAST_FMA)
+    return std::fma(a, b, c);
+#else
+    return a * b + c;
+#endif
+}
+
+inline float fusedMultiplyAdd(const float &a, const float &b, const float &c) {
+#if defined(FP_FAST_FMAF)
+    return std::fma(a, b, c);
+#else
+    return a * b + c;
+#endif
+}
+
+inline long double fusedMultiplyAdd(const long double &a, const long double &b,
+                                    const long double &c) {
+#if defined(FP_FAST_FMAL)
+    return std::fma(a, b, c);
+#else
+    return a * b + c;
+#endif
+}
+
+/**
+ *  A binary functor that returns factor * x + y, fused where the hardware
+ *  allows it.
+ */
+template <typename T = double>
+struct scaled_adder {
+    explicit scaled_adder(const T &factor) : factor(factor) {}
+
+    T operator()(const T &x, const T &y) const {
+        return fusedMultiplyAdd(factor, x, y);
+    }
+
+    T factor;
+};
+
+/**
+ *  Selects how long sums are accumulated: naive adds each term to a running
+ *  sum, compensated carries the rounding error of every addition along (see
+ *  CompensatedSum) at roughly four times the cost.
+ */
+enum class Summation {
+    naive,
+    compensated
+};
+
+/**
+ *  Selects how reciprocal square roots are computed: exact divides by the
+ *  square root, refined improves the hardware estimate with one
+ *  Newton-Raphson step (about 22 bits), and raw uses the estimate as is
+ *  (about 12 bits). The approximations are meant for tree codes and far field
+ *  forces, where full precision is wasted.
+ */
+enum class NormPrecision {
+    exact,
+    refined,
+    raw
+};
+
+/**
+ *  A running sum that tracks the rounding error of every addition and adds it
+ *  back when the result is read (Neumaier's variant of Kahan summation, which
+ *  stays exact when a term is larger than the running sum). The result is
+ *  about as accurate as accumulating in twice the precision of T, which keeps
+ *  small contributions from being swallowed by a single dominant term.
+ */
+template <typename T = double>
+class CompensatedSum {
+public:
+    /**
+     *  Starts the sum at initial.
+     */
+    explicit CompensatedSum(const T &initial = T(0)) : sum_(initial), compensation_(0) {}
+
+    /**
+     *  Adds value and returns the sum for chaining.
+     */
+    CompensatedSum & operator+=(const T &value) {
+        T total = sum_ + value;
+        if (std::abs(sum_) >= std::abs(value))
+            compensation_ += (sum_ - total) + value;
+        else
+            compensation_ += (value - total) + sum_;
+        sum_ = total;
+        return *this;
+    }
+
+    /**
+     *  Returns the sum with the accumulated rounding errors added back.
+     */
+    T sum() const {
+        return sum_ + compensation_;
+    }
+
+private:
+    /**
+     *  The running sum and the rounding errors lost from it.
+     */
+    T sum_;
+    T compensation_;
+};
+
 /**
  *  A structure that looks like an iterator but allows the accumulation of
  *  values produced by std::transform.
@@ -33,14 +155,16 @@ struct multiplier : std::binary_function<double, double, double> {
  *  may be handled any way we wish.
  *
  *  All methods are defined constant so that there only needs to be a single
- *  version of this hack.
+ *  version of this hack. T is the type of the values and A the type they are
+ *  accumulated in, e.g. CompensatedSum<T> for compensated summation.
  */
+template <typename T = double, typename A = T>
 struct accumulator_iter {
 
     /**
      *  Initialize the accumulator to 0.
      */
-    accumulator_iter() : accumulator(0.0) {}
+    accumulator_iter() : accumulator(0) {}
 
     /**
      *  No-op increment operator that simply returns *this. Needed so that
@@ -69,7 +193,7 @@ struct accumulator_iter {
     /**
      *  Increments the accumulator.
      */
-    const accumulator_iter & operator=(double val) const {
+    const accumulator_iter & operator=(T val) const {
         accumulator += val;
         return *this;
     }
@@ -78,7 +202,7 @@ struct accumulator_iter {
      *  Accumulator. Declared mutable so that it can be changed inside const
      *  methods.
      */
-    mutable double accumulator;
+    mutable A accumulator;
 };
 
 #endif
@@ -0,0 +1,127 @@
+#ifndef _VECTOR_KERNELS_H_
+#define _VECTOR_KERNELS_H_
+
+#include <cstddef>
+#include "VectorHelpers.h"
+
+/**
+ *  VECTOR_CONSTANT_EVALUATED() is true while a constexpr Vector operation is
+ *  being evaluated by the compiler. The kernels below are not constexpr, so
+ *  Vector falls back to plain loops in that case. Compilers that cannot tell
+ *  always take the plain loops.
+ */
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_is_constant_evaluated)
+#define VECTOR_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#endif
+#elif defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 9
+#define VECTOR_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#endif
+#ifndef VECTOR_CONSTANT_EVALUATED
+#define VECTOR_CONSTANT_EVALUATED() true
+#endif
+
+/**
+ *  The low level loops behind the eagerly evaluated Vector operations. Each
+ *  kernel works on raw arrays of DIM scalars of type T and may be called with
+ *  out equal to one of its inputs.
+ *
+ *  The generic kernels are written with functors and STL algorithms. The
+ *  double vectors used in the simulation (2, 3 and 4D) are specialized with
+ *  explicit SSE2 (and, when the compiler targets them, AVX and FMA) code since
+ *  compilers do not reliably vectorize the generic versions. They use
+ *  unaligned loads and stores, so Vector needs no more than the alignment of
+ *  its scalars and its layout is the same with and without them. Define
+ *  VECTOR_NO_SIMD to fall back to the generic kernels everywhere.
+ */
+template <size_t DIM, typename T>
+struct VectorKernels {
+    /**
+     *  Stores lhs + rhs in out.
+     */
+    static void add(const T *lhs, const T *rhs, T *out);
+
+    /**
+     *  Stores lhs - rhs in out.
+     */
+    static void subtract(const T *lhs, const T *rhs, T *out);
+
+    /**
+     *  Stores v * factor in out.
+     */
+    static void scale(const T *v, T factor, T *out);
+
+    /**
+     *  Stores a * x + y in out, fused where the hardware allows it.
+     */
+    static void axpy(T a, const T *x, const T *y, T *out);
+
+    /**
+     *  Returns the dot (inner) product of lhs and rhs, accumulated with fused
+     *  multiply-adds where the hardware allows it.
+     */
+    static T dot(const T *lhs, const T *rhs);
+
+    /**
+     *  Scales v in place such that its magnitude is 1.
+     */
+    static void normalize(T *v);
+};
+
+/**
+ *  Returns 1 / sqrt(x) computed as selected by precision. The estimate comes
+ *  from rsqrtss where SSE is available and otherwise from the integer shift
+ *  trick followed by one Newton-Raphson step, which is a few bits less
+ *  accurate. Values outside the range of float are always computed exactly.
+ */
+template <typename T>
+T inverseSqrt(T x, NormPrecision precision);
+
+#if defined(__SSE2__) && !defined(VECTOR_NO_SIMD)
+#define VECTOR_SIMD 1
+
+/**
+ *  SSE2 kernels for 2D vectors: one packed register holds the whole vector.
+ */
+template <>
+struct VectorKernels<2, double> {
+    static void add(const double *lhs, const double *rhs, double *out);
+    static void subtract(const double *lhs, const double *rhs, double *out);
+    static void scale(const double *v, double factor, double *out);
+    static void axpy(double a, const double *x, const double *y, double *out);
+    static double dot(const double *lhs, const double *rhs);
+    static void normalize(double *v);
+};
+
+/**
+ *  SSE2 kernels for 3D vectors: a packed register for x and y plus a scalar
+ *  operation for z.
+ */
+template <>
+struct VectorKernels<3, double> {
+    static void add(const double *lhs, const double *rhs, double *out);
+    static void subtract(const double *lhs, const double *rhs, double *out);
+    static void scale(const double *v, double factor, double *out);
+    static void axpy(double a, const double *x, const double *y, double *out);
+    static double dot(const double *lhs, const double *rhs);
+    static void normalize(double *v);
+};
+
+/**
+ *  SSE2 or AVX kernels for 4D vectors: two packed SSE registers, or a single
+ *  AVX register when available.
+ */
+template <>
+struct VectorKernels<4, double> {
+    static void add(const double *lhs, const double *rhs, double *out);
+    static void subtract(const double *lhs, const double *rhs, double *out);
+    static void scale(const double *v, double factor, double *out);
+    static void axpy(double a, const double *x, const double *y, double *out);
+    static double dot(const double *lhs, const double *rhs);
+    static void normalize(double *v);
+};
+
+#endif
+
+#include "../src/VectorKernels.cpp"
+#endif
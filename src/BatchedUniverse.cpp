@@ -0,0 +1,234 @@
+/**
+ * @class BatchedUniverse.cpp
+ * @brief Steps several copies of a small system in lockstep
+ * @details Quantities are stored lane-minor so the inner loops vectorize
+ *
+ * I affirm that this work is my own
+ * 2016-11-30
+ * @author Edward Goode
+ * VuID: goodees
+ * Email: edward.s.goode@vanderbilt.edu
+ */
+
+#ifndef _BATCHED_UNIVERSE_CPP_
+#define _BATCHED_UNIVERSE_CPP_
+
+#include "../include/BatchedUniverse.h"
+#include "../include/Object.h"
+#include "../include/Universe.h"
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <stdexcept>
+
+/**
+ *  Creates a batch in which every lane is a copy of scene, summing forces the
+ *  way scene does.
+ */
+template <size_t LANES>
+BatchedUniverse<LANES>::BatchedUniverse(const Universe &scene) : summation_(scene.getSummation()){
+    size_t bodies = std::distance(scene.begin(), scene.end());
+    mass_.resize(bodies * LANES);
+    posX_.resize(bodies * LANES);
+    posY_.resize(bodies * LANES);
+    velX_.resize(bodies * LANES);
+    velY_.resize(bodies * LANES);
+    nextX_.resize(bodies * LANES);
+    nextY_.resize(bodies * LANES);
+
+    for (const Object *obj : scene)
+        names_.push_back(obj->getName());
+
+    for (size_t lane = 0; lane < LANES; lane++)
+        loadLane(lane, scene);
+}
+
+/**
+ *  Returns the number of bodies in each lane.
+ */
+template <size_t LANES>
+size_t BatchedUniverse<LANES>::size() const{
+    return names_.size();
+}
+
+/**
+ *  Returns the name of body, shared by every lane.
+ */
+template <size_t LANES>
+const std::string & BatchedUniverse<LANES>::getName(size_t body) const{
+    return names_[body];
+}
+
+/**
+ *  Returns the mass of body in lane.
+ */
+template <size_t LANES>
+double BatchedUniverse<LANES>::getMass(size_t body, size_t lane) const{
+    return mass_[offset(body) + lane];
+}
+
+/**
+ *  Returns the position of body in lane.
+ */
+template <size_t LANES>
+vector2 BatchedUniverse<LANES>::getPosition(size_t body, size_t lane) const{
+    vector2 pos;
+    pos[0] = posX_[offset(body) + lane];
+    pos[1] = posY_[offset(body) + lane];
+    return pos;
+}
+
+/**
+ *  Returns the velocity of body in lane.
+ */
+template <size_t LANES>
+vector2 BatchedUniverse<LANES>::getVelocity(size_t body, size_t lane) const{
+    vector2 vel;
+    vel[0] = velX_[offset(body) + lane];
+    vel[1] = velY_[offset(body) + lane];
+    return vel;
+}
+
+/**
+ *  Sets the position of body in lane.
+ */
+template <size_t LANES>
+void BatchedUniverse<LANES>::setPosition(size_t body, size_t lane, const vector2 &pos){
+    posX_[offset(body) + lane] = pos[0];
+    posY_[offset(body) + lane] = pos[1];
+}
+
+/**
+ *  Sets the velocity of body in lane.
+ */
+template <size_t LANES>
+void BatchedUniverse<LANES>::setVelocity(size_t body, size_t lane, const vector2 &vel){
+    velX_[offset(body) + lane] = vel[0];
+    velY_[offset(body) + lane] = vel[1];
+}
+
+/**
+ *  Copies the masses, positions, and velocities of universe into lane.
+ *  throws an std::invalid_argument if the body counts differ.
+ */
+template <size_t LANES>
+void BatchedUniverse<LANES>::loadLane(size_t lane, const Universe &universe){
+    if (static_cast<size_t>(std::distance(universe.begin(), universe.end())) != size())
+        throw std::invalid_argument("Body count differs from the batch");
+
+    size_t body = 0;
+    for (const Object *obj : universe){
+        mass_[offset(body) + lane] = obj->getMass();
+        setPosition(body, lane, obj->getPosition());
+        setVelocity(body, lane, obj->getVelocity());
+        body++;
+    }
+}
+
+/**
+ *  Copies the positions and velocities of lane into the Objects of
+ *  universe. throws an std::invalid_argument if the body counts differ.
+ */
+template <size_t LANES>
+void BatchedUniverse<LANES>::storeLane(size_t lane, Universe &universe) const{
+    if (static_cast<size_t>(std::distance(universe.begin(), universe.end())) != size())
+        throw std::invalid_argument("Body count differs from the batch");
+
+    size_t body = 0;
+    for (Object *obj : universe){
+        obj->setPosition(getPosition(body, lane));
+        obj->setVelocity(getVelocity(body, lane));
+        body++;
+    }
+}
+
+/**
+ *  Selects how the forces on each body are summed in every lane.
+ */
+template <size_t LANES>
+void BatchedUniverse<LANES>::setSummation(Summation summation){
+    summation_ = summation;
+}
+
+/**
+ *  Returns how the forces on each body are summed.
+ */
+template <size_t LANES>
+Summation BatchedUniverse<LANES>::getSummation() const{
+    return summation_;
+}
+
+/**
+ *  Advances every lane by the provided time step.
+ */
+template <size_t LANES>
+void BatchedUniverse<LANES>::stepSimulation(const double &timeSec){
+    const size_t bodies = size();
+    const bool compensated = summation_ == Summation::compensated;
+
+    // Forces are computed from the positions at the start of the step, so the
+    // updated positions are staged in the scratch buffers and swapped in at
+    // the end. The copy carries over the sun, which is never moved.
+    std::copy(posX_.begin(), posX_.end(), nextX_.begin());
+    std::copy(posY_.begin(), posY_.end(), nextY_.begin());
+
+    for (size_t i = 1; i < bodies; i++){
+        const size_t bi = offset(i);
+        double forceX[LANES] = {};
+        double forceY[LANES] = {};
+        // Used instead under compensated summation, one per component as in
+        // CompensatedSum<vector2>.
+        CompensatedSum<double> sumX[LANES];
+        CompensatedSum<double> sumY[LANES];
+
+        for (size_t j = 0; j < bodies; j++){
+            if (j == i)
+                continue;
+
+            const size_t bj = offset(j);
+            for (size_t lane = 0; lane < LANES; lane++){
+                double dx = posX_[bj + lane] - posX_[bi + lane];
+                double dy = posY_[bj + lane] - posY_[bi + lane];
+                double numerator = Universe::G * mass_[bj + lane] * mass_[bi + lane];
+                double inverseNorm = 1.0 / std::sqrt(fusedMultiplyAdd(dy, dy, dx * dx));
+                double inverseCube = inverseNorm * inverseNorm * inverseNorm;
+                double termX = numerator * (dx * inverseCube);
+                double termY = numerator * (dy * inverseCube);
+                if (compensated){
+                    sumX[lane] += termX;
+                    sumY[lane] += termY;
+                } else {
+                    forceX[lane] += termX;
+                    forceY[lane] += termY;
+                }
+            }
+        }
+
+        for (size_t lane = 0; lane < LANES; lane++){
+            if (compensated){
+                forceX[lane] = sumX[lane].sum();
+                forceY[lane] = sumY[lane].sum();
+            }
+
+            // Fused like Vector::addScaled in Universe::stepSimulation.
+            double inverseMass = 1.0 / mass_[bi + lane];
+            velX_[bi + lane] = fusedMultiplyAdd(timeSec, forceX[lane] * inverseMass, velX_[bi + lane]);
+            velY_[bi + lane] = fusedMultiplyAdd(timeSec, forceY[lane] * inverseMass, velY_[bi + lane]);
+            nextX_[bi + lane] = fusedMultiplyAdd(timeSec, velX_[bi + lane], posX_[bi + lane]);
+            nextY_[bi + lane] = fusedMultiplyAdd(timeSec, velY_[bi + lane], posY_[bi + lane]);
+        }
+    }
+
+    posX_.swap(nextX_);
+    posY_.swap(nextY_);
+}
+
+/**
+ *  Returns the offset of lane 0 of body in the storage.
+ */
+template <size_t LANES>
+size_t BatchedUniverse<LANES>::offset(size_t body){
+    return body * LANES;
+}
+
+#endif
@@ -0,0 +1,91 @@
+/**
+ * @class BinaryFormat.cpp
+ * @brief Parts shared by the binary file formats
+ * @details Checks the headers and reads the name tables of scene files,
+ *          checkpoints and trajectories
+ *
+ * I affirm that this work is my own
+ * 2016-11-30
+ * @author Edward Goode
+ * VuID: goodees
+ * Email: edward.s.goode@vanderbilt.edu
+ */
+
+#ifndef _BINARY_FORMAT_CPP_
+#define _BINARY_FORMAT_CPP_
+
+#include "../include/BinaryFormat.h"
+#include "../include/MappedFile.h"
+#include <cstring>
+#include <stdexcept>
+
+const uint32_t BinaryFormat::byteOrderMark;
+
+/**
+ *  Checks that file starts with a header of headerSize bytes that holds
+ *  magic, the byte order mark of this machine and version.
+ */
+void BinaryFormat::checkHeader(const MappedFile &file, size_t headerSize, const char *magic, uint32_t version,
+                               const std::string &filename, const std::string &kind){
+    const size_t magicSize = 8;
+    uint32_t fields[2];
+    if (file.size() < headerSize || headerSize < magicSize + sizeof(fields)
+            || std::memcmp(file.begin(), magic, magicSize) != 0)
+        throw std::runtime_error(filename + ": not a " + kind);
+
+    std::memcpy(fields, file.begin() + magicSize, sizeof(fields));
+    if (fields[0] != byteOrderMark)
+        throw std::runtime_error(filename + ": written on a machine of different byte order");
+    if (fields[1] != version)
+        throw std::runtime_error(filename + ": unsupported " + kind + " version " + std::to_string(fields[1]));
+}
+
+/**
+ *  Checks the name table at offset of file and returns the offset just past
+ *  its padding.
+ */
+uint64_t BinaryFormat::checkNames(const MappedFile &file, uint64_t offset, uint64_t count, uint64_t namesSize,
+                                  const std::string &filename, const std::string &kind){
+    // Bound the sizes before computing offsets from them so nothing overflows.
+    if (offset > file.size() || count > file.size() / sizeof(uint64_t) || namesSize > file.size())
+        throw std::runtime_error(filename + ": truncated " + kind);
+    const uint64_t names = offset + (count + 1) * sizeof(uint64_t);
+    const uint64_t end = names + namesSize + padding(namesSize);
+    if (end > file.size())
+        throw std::runtime_error(filename + ": truncated " + kind);
+
+    const char *offsets = file.begin() + offset;
+    uint64_t previous = 0;
+    for (uint64_t i = 0; i <= count; i++){
+        uint64_t name;
+        std::memcpy(&name, offsets + i * sizeof(uint64_t), sizeof(name));
+        if (name < previous || name > namesSize || (i == 0 && name != 0))
+            throw std::runtime_error(filename + ": corrupt name table");
+        previous = name;
+    }
+    return end;
+}
+
+/**
+ *  Checks the name table like checkNames, copies it to offsets and names,
+ *  and returns the offset just past its padding.
+ */
+uint64_t BinaryFormat::readNames(const MappedFile &file, uint64_t offset, uint64_t count, uint64_t namesSize,
+                                 const std::string &filename, const std::string &kind,
+                                 std::vector<uint64_t> &offsets, std::string &names){
+    const uint64_t end = checkNames(file, offset, count, namesSize, filename, kind);
+    const char *data = file.begin() + offset;
+    offsets.resize(count + 1);
+    std::memcpy(offsets.data(), data, offsets.size() * sizeof(uint64_t));
+    names.assign(data + offsets.size() * sizeof(uint64_t), namesSize);
+    return end;
+}
+
+/**
+ *  Returns the number of zero bytes that align size bytes to 8.
+ */
+uint64_t BinaryFormat::padding(uint64_t size){
+    return (8 - size % 8) % 8;
+}
+
+#endif
@@ -0,0 +1,229 @@
+/**
+ * @class Checkpoint.cpp
+ * @brief Checkpoint and restart of a Universe
+ * @details Copies the bodies of a Universe into columns and writes them,
+ * together with the simulation state, as raw binary data
+ *
+ * I affirm that this work is my own
+ * 2016-11-30
+ * @author Edward Goode
+ * VuID: goodees
+ * Email: edward.s.goode@vanderbilt.edu
+ */
+
+#ifndef _CHECKPOINT_CPP_
+#define _CHECKPOINT_CPP_
+
+#include "../include/Checkpoint.h"
+#include "../include/BinaryFormat.h"
+#include "../include/MappedFile.h"
+#include "../include/Object.h"
+#include "../include/ObjectFactory.h"
+#include "../include/Universe.h"
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+const uint32_t Checkpoint::version;
+
+/**
+ *  Creates an empty checkpoint.
+ */
+Checkpoint::Checkpoint() : nameOffsets_(1, 0), steps_(0), time_(0.0), publishInterval_(0),
+        summation_(static_cast<uint64_t>(Summation::naive)){
+}
+
+/**
+ *  Captures the state of universe into filename.
+ */
+void Checkpoint::save(const char *filename, const Universe &universe){
+    Checkpoint checkpoint;
+    checkpoint.capture(universe);
+    checkpoint.write(filename);
+}
+
+/**
+ *  Replaces the state of universe with the one saved in filename.
+ */
+void Checkpoint::restore(const char *filename, Universe &universe){
+    Checkpoint checkpoint;
+    checkpoint.read(filename);
+    checkpoint.apply(universe);
+}
+
+/**
+ *  Copies the complete state of universe into this checkpoint.
+ */
+void Checkpoint::capture(const Universe &universe){
+    // clear() keeps the storage of the previous capture.
+    names_.clear();
+    nameOffsets_.assign(1, 0);
+    for (std::vector<double> &column : columns_)
+        column.clear();
+
+    for (const Object *object : universe.objects_){
+        names_ += object->getName();
+        nameOffsets_.push_back(names_.size());
+
+        const vector2 position = object->getPosition();
+        const vector2 velocity = object->getVelocity();
+        columns_[0].push_back(object->getMass());
+        columns_[1].push_back(position[0]);
+        columns_[2].push_back(position[1]);
+        columns_[3].push_back(velocity[0]);
+        columns_[4].push_back(velocity[1]);
+    }
+
+    steps_ = universe.steps_;
+    time_ = universe.time_;
+    publishInterval_ = universe.publishInterval_;
+    summation_ = static_cast<uint64_t>(universe.summation_);
+}
+
+/**
+ *  Replaces the bodies and simulation state of universe with those of this
+ *  checkpoint.
+ */
+void Checkpoint::apply(Universe &universe) const{
+    std::vector<Object*> objects;
+    objects.reserve(size());
+    try {
+        for (size_t i = 0; i < size(); i++){
+            vector2 position, velocity;
+            position[0] = columns_[1][i];
+            position[1] = columns_[2][i];
+            velocity[0] = columns_[3][i];
+            velocity[1] = columns_[4][i];
+            objects.push_back(ObjectFactory::makeObject(
+                    names_.substr(nameOffsets_[i], nameOffsets_[i + 1] - nameOffsets_[i]),
+                    columns_[0][i], position, velocity));
+        }
+    } catch (...){
+        for (Object *object : objects)
+            delete object;
+        throw;
+    }
+
+    universe.swap(objects);
+    universe.steps_ = steps_;
+    universe.time_ = time_;
+    universe.publishInterval_ = publishInterval_;
+    universe.summation_ = static_cast<Summation>(summation_);
+}
+
+/**
+ *  Writes the checkpoint to filename.
+ */
+void Checkpoint::write(const char *filename) const{
+    Header header = makeHeader();
+    header.count = size();
+    header.namesSize = names_.size();
+    header.steps = steps_;
+    header.time = time_;
+    header.publishInterval = publishInterval_;
+    header.summation = summation_;
+
+    const std::string temporary = std::string(filename) + ".tmp";
+    std::unique_ptr<std::FILE, int (*)(std::FILE *)> file(std::fopen(temporary.c_str(), "wb"), &std::fclose);
+    if (!file)
+        throw std::runtime_error("Unable to open " + temporary);
+
+    const char padding[8] = {};
+    bool written = std::fwrite(&header, sizeof(header), 1, file.get()) == 1
+        && std::fwrite(nameOffsets_.data(), sizeof(uint64_t), nameOffsets_.size(), file.get()) == nameOffsets_.size()
+        && std::fwrite(names_.data(), 1, names_.size(), file.get()) == names_.size()
+        && std::fwrite(padding, 1, namePadding(), file.get()) == namePadding();
+    for (const std::vector<double> &column : columns_)
+        written = written && std::fwrite(column.data(), sizeof(double), column.size(), file.get()) == column.size();
+
+    if (!written || std::fclose(file.release()) != 0){
+        std::remove(temporary.c_str());
+        throw std::runtime_error("Unable to write " + temporary);
+    }
+    if (std::rename(temporary.c_str(), filename) != 0)
+        throw std::runtime_error("Unable to replace " + std::string(filename));
+}
+
+/**
+ *  Replaces this checkpoint with the one in filename.
+ */
+void Checkpoint::read(const char *filename){
+    const std::string name(filename);
+    MappedFile file(filename);
+    const Header expected = makeHeader();
+    BinaryFormat::checkHeader(file, sizeof(Header), expected.magic, version, name, "checkpoint");
+    Header header;
+    std::memcpy(&header, file.begin(), sizeof(Header));
+    if (header.summation > static_cast<uint64_t>(Summation::compensated))
+        throw std::runtime_error(name + ": unknown summation");
+
+    // Everything is read into locals first, so that a corrupt file leaves
+    // this checkpoint as it was. The name table bounds the body count, so
+    // the total cannot overflow.
+    const uint64_t count = header.count;
+    std::vector<uint64_t> nameOffsets;
+    std::string names;
+    const uint64_t columnsStart = BinaryFormat::readNames(file, sizeof(Header), count, header.namesSize, name,
+                                                          "checkpoint", nameOffsets, names);
+    if (columnsStart + columnCount * count * sizeof(double) != file.size())
+        throw std::runtime_error(name + ": truncated checkpoint");
+
+    const char *data = file.begin() + columnsStart;
+    std::vector<double> columns[columnCount];
+    for (std::vector<double> &column : columns){
+        column.resize(count);
+        std::memcpy(column.data(), data, count * sizeof(double));
+        data += count * sizeof(double);
+    }
+
+    names_.swap(names);
+    nameOffsets_.swap(nameOffsets);
+    for (size_t c = 0; c < columnCount; c++)
+        columns_[c].swap(columns[c]);
+    steps_ = header.steps;
+    time_ = header.time;
+    publishInterval_ = header.publishInterval;
+    summation_ = header.summation;
+}
+
+/**
+ *  Returns the number of bodies.
+ */
+size_t Checkpoint::size() const{
+    return nameOffsets_.size() - 1;
+}
+
+/**
+ *  Returns the number of steps the Universe had taken.
+ */
+size_t Checkpoint::getStepCount() const{
+    return steps_;
+}
+
+/**
+ *  Returns the simulated time of the Universe in seconds.
+ */
+double Checkpoint::getTime() const{
+    return time_;
+}
+
+/**
+ *  Returns header with the magic, byte order mark and version filled in.
+ */
+Checkpoint::Header Checkpoint::makeHeader(){
+    Header header = Header();
+    std::memcpy(header.magic, "NBCHKPT", sizeof(header.magic));
+    header.byteOrder = BinaryFormat::byteOrderMark;
+    header.version = version;
+    return header;
+}
+
+/**
+ *  Returns the number of zero bytes that align the names to 8 bytes.
+ */
+size_t Checkpoint::namePadding() const{
+    return BinaryFormat::padding(names_.size());
+}
+
+#endif
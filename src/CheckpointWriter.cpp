@@ -0,0 +1,115 @@
+/**
+ * @class CheckpointWriter.cpp
+ * @brief Background checkpoint writer
+ * @details Double buffers Checkpoints so that writing one to disk overlaps
+ * with the simulation
+ *
+ * I affirm that this work is my own
+ * 2016-11-30
+ * @author Edward Goode
+ * VuID: goodees
+ * Email: edward.s.goode@vanderbilt.edu
+ */
+
+#ifndef _CHECKPOINT_WRITER_CPP_
+#define _CHECKPOINT_WRITER_CPP_
+
+#include "../include/CheckpointWriter.h"
+
+/**
+ *  Starts the writer thread.
+ */
+CheckpointWriter::CheckpointWriter() : pending_(none), writing_(none), stopping_(false),
+        thread_(&CheckpointWriter::work, this){
+}
+
+/**
+ *  Finishes writing every queued checkpoint and stops the writer thread.
+ */
+CheckpointWriter::~CheckpointWriter(){
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    changed_.notify_all();
+    thread_.join();
+}
+
+/**
+ *  Captures the state of universe and queues it to be written to filename.
+ */
+void CheckpointWriter::save(const char *filename, const Universe &universe){
+    size_t buffer;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        changed_.wait(lock, [this]() { return pending_ == none; });
+        rethrowError();
+        buffer = writing_ == 0 ? 1 : 0;
+    }
+
+    // Nothing else touches a buffer that is neither pending nor being
+    // written, so the copy needs no lock.
+    buffers_[buffer].capture(universe);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        filenames_[buffer] = filename;
+        pending_ = buffer;
+    }
+    changed_.notify_all();
+}
+
+/**
+ *  Blocks until every queued checkpoint has been written.
+ */
+void CheckpointWriter::wait(){
+    std::unique_lock<std::mutex> lock(mutex_);
+    changed_.wait(lock, [this]() { return pending_ == none && writing_ == none; });
+    rethrowError();
+}
+
+/**
+ *  Body of the writer thread.
+ */
+void CheckpointWriter::work(){
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (true){
+        changed_.wait(lock, [this]() { return stopping_ || pending_ != none; });
+        if (pending_ == none)
+            return;
+
+        const size_t buffer = pending_;
+        writing_ = buffer;
+        pending_ = none;
+        // The other buffer is free for the next capture now.
+        changed_.notify_all();
+        lock.unlock();
+
+        try {
+            buffers_[buffer].write(filenames_[buffer].c_str());
+        } catch (...) {
+            lock.lock();
+            if (!error_)
+                error_ = std::current_exception();
+            lock.unlock();
+        }
+
+        lock.lock();
+        writing_ = none;
+        changed_.notify_all();
+    }
+}
+
+/**
+ *  Rethrows and clears the first error of the writer thread, if any.
+ */
+void CheckpointWriter::rethrowError(){
+    if (error_){
+        std::exception_ptr error = error_;
+        error_ = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+#endif
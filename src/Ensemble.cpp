@@ -0,0 +1,121 @@
+/**
+ * @class Ensemble.cpp
+ * @brief Runs many perturbed copies of a scene across a thread pool
+ * @details Each member gets its own Universe and is stepped on one worker
+ *
+ * I affirm that this work is my own
+ * 2016-11-30
+ * @author Edward Goode
+ * VuID: goodees
+ * Email: edward.s.goode@vanderbilt.edu
+ */
+
+#ifndef _ENSEMBLE_CPP_
+#define _ENSEMBLE_CPP_
+
+#include "../include/Ensemble.h"
+#include "../include/Object.h"
+#include "../include/ThreadPool.h"
+#include "../include/Universe.h"
+#include <cstdint>
+#include <random>
+#include <vector>
+
+/**
+ *  Creates an ensemble of the bodies in scene. The scene is only read, and
+ *  must outlive every call to run().
+ */
+Ensemble::Ensemble(const Universe &scene, const Perturbation &perturb) :
+        scene_(scene), perturb_(perturb){
+}
+
+/**
+ *  Steps members copies of the scene steps times by timeSec each, using
+ *  pool, and streams their summaries to sink. Returns once every member
+ *  has finished.
+ */
+void Ensemble::run(size_t members, size_t steps, double timeSec, ThreadPool &pool,
+                   const SummarySink &sink) const{
+    ThreadPool::Batch batch(pool);
+    for (size_t member = 0; member < members; member++)
+        batch.submit([this, member, steps, timeSec, &sink]() {
+            runMember(member, steps, timeSec, sink);
+        });
+
+    batch.wait();
+}
+
+/**
+ *  Returns a perturbation that scales the velocity of every body except
+ *  the first (the "sun") by 1 + N(0, sigma) per component. Member m always
+ *  draws from the same random stream, so runs are reproducible.
+ */
+Ensemble::Perturbation Ensemble::velocityNoise(double sigma, unsigned long seed){
+    return [sigma, seed](size_t member, Universe &universe) {
+        // Seeding with both values keeps the streams of neighbouring seeds
+        // from overlapping, as seed + member would. seed_seq keeps 32 bits
+        // of each value, so both are split in halves.
+        const uint64_t wideSeed = seed, wideMember = member;
+        std::seed_seq sequence{uint32_t(wideSeed), uint32_t(wideSeed >> 32),
+                               uint32_t(wideMember), uint32_t(wideMember >> 32)};
+        std::mt19937_64 engine(sequence);
+        std::normal_distribution<double> noise(0.0, sigma);
+
+        for (Universe::iterator it = universe.begin(); it != universe.end(); ++it){
+            if (it == universe.begin())
+                continue;
+
+            vector2 velocity = (*it)->getVelocity();
+            velocity[0] *= 1.0 + noise(engine);
+            velocity[1] *= 1.0 + noise(engine);
+            (*it)->setVelocity(velocity);
+        }
+    };
+}
+
+/**
+ *  Returns the total kinetic plus gravitational potential energy.
+ */
+double Ensemble::getEnergy(const Universe &universe){
+    double energy = 0.0;
+
+    for (Universe::const_iterator i = universe.begin(); i != universe.end(); ++i){
+        energy += 0.5 * (*i)->getMass() * (*i)->getVelocity().normSq();
+
+        for (Universe::const_iterator j = i + 1; j != universe.end(); ++j){
+            double distance = ((*i)->getPosition() - (*j)->getPosition()).norm();
+            energy -= Universe::G * (*i)->getMass() * (*j)->getMass() / distance;
+        }
+    }
+
+    return energy;
+}
+
+/**
+ *  Creates, perturbs, and steps a single member.
+ */
+void Ensemble::runMember(size_t member, size_t steps, double timeSec, const SummarySink &sink) const{
+    Universe universe;
+    std::vector<Object*> bodies = scene_.getSnapshot();
+    universe.swap(bodies);
+    universe.setSummation(scene_.getSummation());
+
+    if (perturb_)
+        perturb_(member, universe);
+
+    MemberSummary summary;
+    summary.member = member;
+    summary.initialEnergy = getEnergy(universe);
+
+    for (size_t step = 0; step < steps; step++)
+        universe.stepSimulation(timeSec);
+
+    summary.finalEnergy = getEnergy(universe);
+    universe.publishState();
+    summary.finalState = universe.getState();
+
+    std::lock_guard<std::mutex> lock(sinkMutex_);
+    sink(summary);
+}
+
+#endif
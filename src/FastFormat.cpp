@@ -0,0 +1,423 @@
+/**
+ * @class FastFormat.cpp
+ * @brief Shortest round-trip formatting of floating point numbers
+ * @details Grisu2 digit generation with a table of cached powers of ten,
+ *          following Loitsch's paper
+ *
+ * I affirm that this work is my own
+ * 2016-11-30
+ * @author Edward Goode
+ * VuID: goodees
+ * Email: edward.s.goode@vanderbilt.edu
+ */
+
+#ifndef _FAST_FORMAT_CPP_
+#define _FAST_FORMAT_CPP_
+
+#include "../include/FastFormat.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+/**
+ *  Powers of ten from 10^-348 to 10^340 in steps of 8, as normalized 64 bit
+ *  significands rounded to nearest and their binary exponents.
+ */
+static const struct {
+    uint64_t f;
+    int e;
+} cachedPowers[] = {
+        {0xfa8fd5a0081c0288ULL, -1220},
+        {0xbaaee17fa23ebf76ULL, -1193},
+        {0x8b16fb203055ac76ULL, -1166},
+        {0xcf42894a5dce35eaULL, -1140},
+        {0x9a6bb0aa55653b2dULL, -1113},
+        {0xe61acf033d1a45dfULL, -1087},
+        {0xab70fe17c79ac6caULL, -1060},
+        {0xff77b1fcbebcdc4fULL, -1034},
+        {0xbe5691ef416bd60cULL, -1007},
+        {0x8dd01fad907ffc3cULL, -980},
+        {0xd3515c2831559a83ULL, -954},
+        {0x9d71ac8fada6c9b5ULL, -927},
+        {0xea9c227723ee8bcbULL, -901},
+        {0xaecc49914078536dULL, -874},
+        {0x823c12795db6ce57ULL, -847},
+        {0xc21094364dfb5637ULL, -821},
+        {0x9096ea6f3848984fULL, -794},
+        {0xd77485cb25823ac7ULL, -768},
+        {0xa086cfcd97bf97f4ULL, -741},
+        {0xef340a98172aace5ULL, -715},
+        {0xb23867fb2a35b28eULL, -688},
+        {0x84c8d4dfd2c63f3bULL, -661},
+        {0xc5dd44271ad3cdbaULL, -635},
+        {0x936b9fcebb25c996ULL, -608},
+        {0xdbac6c247d62a584ULL, -582},
+        {0xa3ab66580d5fdaf6ULL, -555},
+        {0xf3e2f893dec3f126ULL, -529},
+        {0xb5b5ada8aaff80b8ULL, -502},
+        {0x87625f056c7c4a8bULL, -475},
+        {0xc9bcff6034c13053ULL, -449},
+        {0x964e858c91ba2655ULL, -422},
+        {0xdff9772470297ebdULL, -396},
+        {0xa6dfbd9fb8e5b88fULL, -369},
+        {0xf8a95fcf88747d94ULL, -343},
+        {0xb94470938fa89bcfULL, -316},
+        {0x8a08f0f8bf0f156bULL, -289},
+        {0xcdb02555653131b6ULL, -263},
+        {0x993fe2c6d07b7facULL, -236},
+        {0xe45c10c42a2b3b06ULL, -210},
+        {0xaa242499697392d3ULL, -183},
+        {0xfd87b5f28300ca0eULL, -157},
+        {0xbce5086492111aebULL, -130},
+        {0x8cbccc096f5088ccULL, -103},
+        {0xd1b71758e219652cULL, -77},
+        {0x9c40000000000000ULL, -50},
+        {0xe8d4a51000000000ULL, -24},
+        {0xad78ebc5ac620000ULL, 3},
+        {0x813f3978f8940984ULL, 30},
+        {0xc097ce7bc90715b3ULL, 56},
+        {0x8f7e32ce7bea5c70ULL, 83},
+        {0xd5d238a4abe98068ULL, 109},
+        {0x9f4f2726179a2245ULL, 136},
+        {0xed63a231d4c4fb27ULL, 162},
+        {0xb0de65388cc8ada8ULL, 189},
+        {0x83c7088e1aab65dbULL, 216},
+        {0xc45d1df942711d9aULL, 242},
+        {0x924d692ca61be758ULL, 269},
+        {0xda01ee641a708deaULL, 295},
+        {0xa26da3999aef774aULL, 322},
+        {0xf209787bb47d6b85ULL, 348},
+        {0xb454e4a179dd1877ULL, 375},
+        {0x865b86925b9bc5c2ULL, 402},
+        {0xc83553c5c8965d3dULL, 428},
+        {0x952ab45cfa97a0b3ULL, 455},
+        {0xde469fbd99a05fe3ULL, 481},
+        {0xa59bc234db398c25ULL, 508},
+        {0xf6c69a72a3989f5cULL, 534},
+        {0xb7dcbf5354e9beceULL, 561},
+        {0x88fcf317f22241e2ULL, 588},
+        {0xcc20ce9bd35c78a5ULL, 614},
+        {0x98165af37b2153dfULL, 641},
+        {0xe2a0b5dc971f303aULL, 667},
+        {0xa8d9d1535ce3b396ULL, 694},
+        {0xfb9b7cd9a4a7443cULL, 720},
+        {0xbb764c4ca7a44410ULL, 747},
+        {0x8bab8eefb6409c1aULL, 774},
+        {0xd01fef10a657842cULL, 800},
+        {0x9b10a4e5e9913129ULL, 827},
+        {0xe7109bfba19c0c9dULL, 853},
+        {0xac2820d9623bf429ULL, 880},
+        {0x80444b5e7aa7cf85ULL, 907},
+        {0xbf21e44003acdd2dULL, 933},
+        {0x8e679c2f5e44ff8fULL, 960},
+        {0xd433179d9c8cb841ULL, 986},
+        {0x9e19db92b4e31ba9ULL, 1013},
+        {0xeb96bf6ebadf77d9ULL, 1039},
+        {0xaf87023b9bf0ee6bULL, 1066},
+};
+
+/**
+ *  Powers of ten that fit in 64 bits.
+ */
+static const uint64_t powersOfTen[] = {
+        1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+        100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL,
+        10000000000000ULL, 100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+        100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL
+};
+
+/**
+ *  Writes value to buffer, which must have room for maxLength characters,
+ *  and returns a pointer one past the last character written. The text is
+ *  not null terminated.
+ */
+char * FastFormat::format(double value, char *buffer){
+    char *special = formatSpecial(value, buffer);
+    if (special)
+        return special;
+
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    if (value < 0)
+        *buffer++ = '-';
+
+    const int biased = static_cast<int>((bits >> 52) & 0x7FF);
+    const uint64_t fraction = bits & ((1ULL << 52) - 1);
+    char digits[20];
+    int exponent = 0;
+    int length;
+
+    if (biased == 0)
+        length = grisu2(fraction, -1074, false, digits, exponent);
+    else
+        length = grisu2(fraction | (1ULL << 52), biased - 1075, fraction == 0 && biased > 1,
+                        digits, exponent);
+
+    return layout(digits, length, exponent, buffer);
+}
+
+/**
+ *  Writes value to buffer using the shortest text that reads back as the
+ *  same float.
+ */
+char * FastFormat::format(float value, char *buffer){
+    char *special = formatSpecial(value, buffer);
+    if (special)
+        return special;
+
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    if (value < 0)
+        *buffer++ = '-';
+
+    const int biased = static_cast<int>((bits >> 23) & 0xFF);
+    const uint32_t fraction = bits & ((1U << 23) - 1);
+    char digits[20];
+    int exponent = 0;
+    int length;
+
+    if (biased == 0)
+        length = grisu2(fraction, -149, false, digits, exponent);
+    else
+        length = grisu2(fraction | (1U << 23), biased - 150, fraction == 0 && biased > 1,
+                        digits, exponent);
+
+    return layout(digits, length, exponent, buffer);
+}
+
+/**
+ *  Writes value to buffer. Values that are exactly representable as
+ *  doubles are written as such; others with enough digits to read back
+ *  as the same long double.
+ */
+char * FastFormat::format(long double value, char *buffer){
+    const double narrow = static_cast<double>(value);
+    if (static_cast<long double>(narrow) == value || std::isnan(value))
+        return format(narrow, buffer);
+
+    // Rare enough that the C library is fast enough. 21 significant digits
+    // round trip the 64 bit significand of the x87 format.
+    int length = std::snprintf(buffer, maxLength, "%.21Lg", value);
+    return buffer + length;
+}
+
+/*******************************************************************************
+*                                                                              *
+*                                  G R I S U 2                                 *
+*                                                                              *
+*******************************************************************************/
+
+/**
+ *  Returns x * y rounded to the 64 most significant bits.
+ */
+FastFormat::DiyFp FastFormat::multiply(const DiyFp &x, const DiyFp &y){
+    const uint64_t mask = 0xFFFFFFFFULL;
+    const uint64_t a = x.f >> 32, b = x.f & mask;
+    const uint64_t c = y.f >> 32, d = y.f & mask;
+    const uint64_t ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+
+    // The middle terms, plus half of the discarded low word for rounding.
+    uint64_t middle = (bd >> 32) + (ad & mask) + (bc & mask) + (1ULL << 31);
+    DiyFp product = {ac + (ad >> 32) + (bc >> 32) + (middle >> 32), x.e + y.e + 64};
+    return product;
+}
+
+/**
+ *  Returns x shifted such that the most significant bit of f is set.
+ */
+FastFormat::DiyFp FastFormat::normalize(DiyFp x){
+#if defined(__GNUC__)
+    const int shift = __builtin_clzll(x.f);
+    x.f <<= shift;
+    x.e -= shift;
+#else
+    while (!(x.f & (1ULL << 63))){
+        x.f <<= 1;
+        x.e--;
+    }
+#endif
+    return x;
+}
+
+/**
+ *  Returns the cached power of ten c = 10^-k such that the product with a
+ *  number of binary exponent e has an exponent in [-60, -32], and stores k
+ *  in decimalExponent.
+ */
+FastFormat::DiyFp FastFormat::cachedPower(int e, int &decimalExponent){
+    // k = ceil((-61 - e) * log10(2)), offset by 347 to stay positive.
+    double dk = (-61 - e) * 0.30102999566398114 + 347;
+    int k = static_cast<int>(dk);
+    if (dk - k > 0.0)
+        k++;
+
+    const unsigned index = static_cast<unsigned>((k >> 3) + 1);
+    decimalExponent = -(-348 + static_cast<int>(index << 3));
+    DiyFp power = {cachedPowers[index].f, cachedPowers[index].e};
+    return power;
+}
+
+/**
+ *  Generates the shortest digits of the number whose significand is
+ *  significand * 2^e. lowerIsCloser is true for powers of two whose lower
+ *  neighbour is half as far away as the upper one. Stores the digits in
+ *  digits and returns their count; the value is digits * 10^exponent.
+ */
+int FastFormat::grisu2(uint64_t significand, int e, bool lowerIsCloser, char *digits, int &exponent){
+    // Boundaries halfway to the neighbouring floating point numbers.
+    DiyFp upper = normalize(DiyFp{(significand << 1) + 1, e - 1});
+    DiyFp lower = lowerIsCloser ? DiyFp{(significand << 2) - 1, e - 2}
+                                : DiyFp{(significand << 1) - 1, e - 1};
+    lower.f <<= lower.e - upper.e;
+    lower.e = upper.e;
+
+    const DiyFp power = cachedPower(upper.e, exponent);
+    const DiyFp w = multiply(normalize(DiyFp{significand, e}), power);
+    DiyFp scaledUpper = multiply(upper, power);
+    DiyFp scaledLower = multiply(lower, power);
+
+    // Shrink the interval by the multiplication error to stay inside it.
+    scaledUpper.f--;
+    scaledLower.f++;
+    return generateDigits(w, scaledUpper, scaledUpper.f - scaledLower.f, digits, exponent);
+}
+
+/**
+ *  Generates digits of the scaled number w within the scaled rounding
+ *  interval [upper - delta, upper].
+ */
+int FastFormat::generateDigits(const DiyFp &w, const DiyFp &upper, uint64_t delta,
+                               char *digits, int &exponent){
+    const int shift = -upper.e;
+    const uint64_t one = 1ULL << shift;
+    const uint64_t distance = upper.f - w.f;
+
+    // upper = integral + fractional / one, with the integral part < 2^32.
+    uint32_t integral = static_cast<uint32_t>(upper.f >> shift);
+    uint64_t fractional = upper.f & (one - 1);
+    int length = 0;
+
+    int kappa = 1;
+    while (kappa < 10 && integral >= powersOfTen[kappa])
+        kappa++;
+
+    while (kappa > 0){
+        const uint32_t divisor = static_cast<uint32_t>(powersOfTen[kappa - 1]);
+        const uint32_t digit = integral / divisor;
+        integral %= divisor;
+        if (digit || length)
+            digits[length++] = static_cast<char>('0' + digit);
+        kappa--;
+
+        const uint64_t rest = (static_cast<uint64_t>(integral) << shift) + fractional;
+        if (rest <= delta){
+            exponent += kappa;
+            roundWeed(digits, length, delta, rest, powersOfTen[kappa] << shift, distance);
+            return length;
+        }
+    }
+
+    for (;;){
+        fractional *= 10;
+        delta *= 10;
+        const char digit = static_cast<char>(fractional >> shift);
+        if (digit || length)
+            digits[length++] = static_cast<char>('0' + digit);
+        fractional &= one - 1;
+        kappa--;
+
+        if (fractional < delta){
+            exponent += kappa;
+            const int index = -kappa;
+            roundWeed(digits, length, delta, fractional, one,
+                      index < 20 ? distance * powersOfTen[index] : 0);
+            return length;
+        }
+    }
+}
+
+/**
+ *  Moves the last digit towards w while the result stays within the
+ *  rounding interval.
+ */
+void FastFormat::roundWeed(char *digits, int length, uint64_t delta, uint64_t rest,
+                           uint64_t tenKappa, uint64_t distance){
+    while (rest < distance && delta - rest >= tenKappa &&
+           (rest + tenKappa < distance || distance - rest > rest + tenKappa - distance)){
+        digits[length - 1]--;
+        rest += tenKappa;
+    }
+}
+
+/**
+ *  Writes digits * 10^exponent in fixed or exponential notation.
+ */
+char * FastFormat::layout(const char *digits, int length, int exponent, char *buffer){
+    // Position of the decimal point relative to the first digit.
+    const int point = length + exponent;
+
+    if (length <= point && point <= 21){
+        // Integer: 149597870700
+        std::memcpy(buffer, digits, length);
+        buffer += length;
+        for (int i = length; i < point; i++)
+            *buffer++ = '0';
+    } else if (0 < point && point <= 21){
+        // Fraction with an integral part: 123.456
+        std::memcpy(buffer, digits, point);
+        buffer += point;
+        *buffer++ = '.';
+        std::memcpy(buffer, digits + point, length - point);
+        buffer += length - point;
+    } else if (-6 < point && point <= 0){
+        // Small fraction: 0.000123
+        *buffer++ = '0';
+        *buffer++ = '.';
+        for (int i = point; i < 0; i++)
+            *buffer++ = '0';
+        std::memcpy(buffer, digits, length);
+        buffer += length;
+    } else {
+        // Exponential: 1.98892e+30
+        *buffer++ = digits[0];
+        if (length > 1){
+            *buffer++ = '.';
+            std::memcpy(buffer, digits + 1, length - 1);
+            buffer += length - 1;
+        }
+        int power = point - 1;
+        *buffer++ = 'e';
+        *buffer++ = power < 0 ? '-' : '+';
+        if (power < 0)
+            power = -power;
+        if (power >= 100)
+            *buffer++ = static_cast<char>('0' + power / 100);
+        if (power >= 10)
+            *buffer++ = static_cast<char>('0' + power / 10 % 10);
+        *buffer++ = static_cast<char>('0' + power % 10);
+    }
+    return buffer;
+}
+
+/**
+ *  Writes zeros, infinities and NaNs. Returns nullptr if value is finite
+ *  and non-zero.
+ */
+template <typename T>
+char * FastFormat::formatSpecial(T value, char *buffer){
+    const char *text;
+    if (std::isnan(value))
+        text = "nan";
+    else if (std::isinf(value))
+        text = value < 0 ? "-inf" : "inf";
+    else if (value == 0)
+        text = std::signbit(value) ? "-0" : "0";
+    else
+        return nullptr;
+
+    const size_t length = std::strlen(text);
+    std::memcpy(buffer, text, length);
+    return buffer + length;
+}
+
+#endif
@@ -0,0 +1,99 @@
+/**
+ * @class MappedFile.cpp
+ * @brief Read-only memory mapped file
+ * @details Maps the file with mmap where available and falls back to reading
+ *          it into a buffer
+ *
+ * I affirm that this work is my own
+ * 2016-11-30
+ * @author Edward Goode
+ * VuID: goodees
+ * Email: edward.s.goode@vanderbilt.edu
+ */
+
+#ifndef _MAPPED_FILE_CPP_
+#define _MAPPED_FILE_CPP_
+
+#include "../include/MappedFile.h"
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MAPPED_FILE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ *  Opens and maps filename. throws an std::runtime_error if the file cannot
+ *  be read.
+ */
+MappedFile::MappedFile(const char *filename, Access access) : mapping_(nullptr), size_(0){
+#if defined(MAPPED_FILE_MMAP)
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error(std::string("Unable to open ") + filename);
+
+    struct stat info;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0){
+        void *mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED){
+            // Sequential scans profit from aggressive read ahead, which
+            // only wastes I/O when seeking around in the file.
+            madvise(mapping, info.st_size, access == random ? MADV_RANDOM : MADV_SEQUENTIAL);
+            mapping_ = mapping;
+            size_ = info.st_size;
+        }
+    }
+    close(fd);
+
+    if (mapping_ != nullptr)
+        return;
+#else
+    static_cast<void>(access);
+#endif
+
+    // Empty files, pipes, and systems without mmap.
+    std::ifstream file(filename, std::ios::binary);
+    if (!file)
+        throw std::runtime_error(std::string("Unable to open ") + filename);
+    buffer_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    size_ = buffer_.size();
+}
+
+/**
+ *  Unmaps the file.
+ */
+MappedFile::~MappedFile(){
+#if defined(MAPPED_FILE_MMAP)
+    if (mapping_ != nullptr)
+        munmap(mapping_, size_);
+#endif
+}
+
+/**
+ *  Returns the first byte of the file.
+ */
+const char * MappedFile::begin() const{
+    return mapping_ != nullptr ? static_cast<const char *>(mapping_) : buffer_.data();
+}
+
+/**
+ *  Returns one past the last byte of the file.
+ */
+const char * MappedFile::end() const{
+    return begin() + size_;
+}
+
+/**
+ *  Returns the size of the file in bytes.
+ */
+size_t MappedFile::size() const{
+    return size_;
+}
+
+#endif
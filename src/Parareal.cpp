@@ -0,0 +1,171 @@
+/**
+ * @class Parareal.cpp
+ * @brief Time-parallel integration with the parareal algorithm
+ * @details Refines time slices concurrently with stepSimulation
+ *
+ * I affirm that this work is my own
+ * 2016-11-30
+ * @author Edward Goode
+ * VuID: goodees
+ * Email: edward.s.goode@vanderbilt.edu
+ */
+
+#ifndef _PARAREAL_CPP_
+#define _PARAREAL_CPP_
+
+#include "../include/Parareal.h"
+#include "../include/Object.h"
+#include "../include/ThreadPool.h"
+#include "../include/Universe.h"
+#include "../include/UniverseObserver.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+/**
+ *  Creates an integrator whose fine and coarse propagators advance with
+ *  fineStep and coarseStep seconds respectively.
+ */
+Parareal::Parareal(double fineStep, double coarseStep, double tolerance, size_t maxIterations) :
+        fineStep_(fineStep), coarseStep_(coarseStep), tolerance_(tolerance),
+        maxIterations_(maxIterations){
+}
+
+/**
+ *  Advances universe by duration seconds split into slices time slices
+ *  refined concurrently on pool. Returns the number of iterations taken.
+ */
+size_t Parareal::integrate(Universe &universe, double duration, size_t slices, ThreadPool &pool) const{
+    if (slices == 0)
+        throw std::invalid_argument("Parareal needs at least one time slice");
+    // lround of a non-finite step count is unspecified.
+    if (!(fineStep_ > 0) || !(coarseStep_ > 0) || !std::isfinite(fineStep_) || !std::isfinite(coarseStep_))
+        throw std::invalid_argument("Parareal time steps must be positive and finite");
+
+    const double sliceSec = duration / slices;
+    const size_t fineSteps = std::max<long>(1, std::lround(sliceSec / fineStep_));
+    const size_t coarseSteps = std::max<long>(1, std::lround(sliceSec / coarseStep_));
+    const double fineSec = sliceSec / fineSteps;
+    const double coarseSec = sliceSec / coarseSteps;
+    const Summation summation = universe.getSummation();
+
+    std::vector<Object*> bodies(universe.begin(), universe.end());
+    std::vector<State> boundary(slices + 1);
+    for (Object *obj : bodies){
+        boundary[0].positions.push_back(obj->getPosition());
+        boundary[0].velocities.push_back(obj->getVelocity());
+    }
+
+    // Initial serial coarse sweep.
+    std::vector<State> coarse(slices);
+    for (size_t n = 0; n < slices; n++){
+        coarse[n] = propagate(bodies, boundary[n], coarseSteps, coarseSec, summation);
+        boundary[n + 1] = coarse[n];
+    }
+
+    std::vector<State> fine(slices);
+    size_t iteration = 0;
+    // Slices before this one have converged exactly.
+    size_t exact = 0;
+
+    while (iteration < maxIterations_ && exact < slices){
+        iteration++;
+
+        ThreadPool::Batch batch(pool);
+        for (size_t n = exact; n < slices; n++)
+            batch.submit([&, n]() {
+                fine[n] = propagate(bodies, boundary[n], fineSteps, fineSec, summation);
+            });
+        batch.wait();
+
+        // Serial correction sweep. The boundary at exact is unchanged from
+        // the previous iteration, so its slice is now the fine solution.
+        double change = 0.0;
+        double scale = 0.0;
+
+        for (size_t n = exact; n < slices; n++){
+            State next = fine[n];
+
+            if (n != exact){
+                State guess = propagate(bodies, boundary[n], coarseSteps, coarseSec, summation);
+                for (size_t b = 0; b < bodies.size(); b++){
+                    next.positions[b] = guess.positions[b] + (next.positions[b] - coarse[n].positions[b]);
+                    next.velocities[b] = guess.velocities[b] + (next.velocities[b] - coarse[n].velocities[b]);
+                }
+                coarse[n] = guess;
+            }
+
+            change = std::max(change, distance(next, boundary[n + 1]));
+            for (const vector2 &pos : next.positions)
+                scale = std::max(scale, pos.norm());
+
+            boundary[n + 1] = next;
+        }
+
+        exact++;
+        if (change <= tolerance_ * scale)
+            break;
+    }
+
+    // Replay the slice boundaries as if each slice were one step, so that
+    // published states and observers follow the run.
+    const double startSec = universe.time_;
+    for (size_t n = 1; n <= slices; n++){
+        for (size_t b = 0; b < bodies.size(); b++){
+            bodies[b]->setPosition(boundary[n].positions[b]);
+            bodies[b]->setVelocity(boundary[n].velocities[b]);
+        }
+        universe.steps_ += fineSteps;
+        universe.time_ = n == slices ? startSec + duration : startSec + n * sliceSec;
+
+        const size_t interval = universe.publishInterval_;
+        if (interval != 0 && universe.steps_ / interval != (universe.steps_ - fineSteps) / interval)
+            universe.publishState();
+
+        for (UniverseObserver *observer : universe.observers_)
+            observer->stepped(universe);
+    }
+
+    return iteration;
+}
+
+/**
+ *  Returns the result of stepping state steps times by timeSec, using a
+ *  private Universe populated with clones of bodies that sums forces as
+ *  selected by summation.
+ */
+Parareal::State Parareal::propagate(const std::vector<Object*> &bodies, const State &state,
+                                    size_t steps, double timeSec, Summation summation){
+    Universe universe;
+    universe.setSummation(summation);
+    for (size_t b = 0; b < bodies.size(); b++){
+        Object *obj = bodies[b]->clone();
+        obj->setPosition(state.positions[b]);
+        obj->setVelocity(state.velocities[b]);
+        universe.addObject(obj);
+    }
+
+    for (size_t step = 0; step < steps; step++)
+        universe.stepSimulation(timeSec);
+
+    State result;
+    for (const Object *obj : universe){
+        result.positions.push_back(obj->getPosition());
+        result.velocities.push_back(obj->getVelocity());
+    }
+
+    return result;
+}
+
+/**
+ *  Returns the largest difference between the positions of lhs and rhs.
+ */
+double Parareal::distance(const State &lhs, const State &rhs){
+    double largest = 0.0;
+    for (size_t b = 0; b < lhs.positions.size(); b++)
+        largest = std::max(largest, (lhs.positions[b] - rhs.positions[b]).norm());
+
+    return largest;
+}
+
+#endif
@@ -1,7 +1,9 @@
 /**
  * @class Parser.cpp
  * @brief Parser for graduate portion
- * @details Needed to implement loadFile in order for tests to run
+ * @details Maps the script into memory, splits it into fields on delims()
+ * without iostreams, converts the numbers with a fast exact path that falls
+ * back to strtod, and registers all bodies with the Universe at once
  *
  * I affirm that this work is my own
  * 2016-11-30
@@ -14,17 +16,424 @@
 #define _PARSER_CPP_
 
 #include "../include/Parser.h"
-#include <iostream>
-#include <fstream>
+#include "../include/MappedFile.h"
+#include "../include/Object.h"
+#include "../include/ObjectFactory.h"
+#include "../include/ThreadPool.h"
+#include "../include/Universe.h"
+#include <algorithm>
+#include <cfloat>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+/**
+ *  Creates a Parser that configures the default instance of the Universe.
+ */
+Parser::Parser() : universe_(nullptr){
+}
+
+/**
+ *  Creates a Parser that configures universe.
+ */
+Parser::Parser(Universe &universe) : universe_(&universe){
+}
 
 /**
  *  Loads the script file and configures the Universe. Consult the
  *  assignment PDF for the syntax of the scripts.
  */
 void Parser::loadFile(char const* filename){
-    std::ifstream myfile(filename);
-    if(myfile.is_open())
-        myfile.close();
+    MappedFile file(filename);
+    try {
+        loadText(file.begin(), file.end());
+    } catch (const std::runtime_error &error){
+        throw std::runtime_error(std::string(filename) + ": " + error.what());
+    }
+}
+
+/**
+ *  Loads a script that is already in memory.
+ */
+void Parser::loadText(const char *begin, const char *end){
+    std::vector<Object*> objects;
+    parseLines(begin, end, 1, objects);
+    universe().addObjects(objects);
+}
+
+/**
+ *  Loads the script file using the workers of pool.
+ */
+void Parser::loadFile(const char *filename, ThreadPool &pool){
+    MappedFile file(filename);
+    try {
+        loadText(file.begin(), file.end(), pool);
+    } catch (const std::runtime_error &error){
+        throw std::runtime_error(std::string(filename) + ": " + error.what());
+    }
+}
+
+/**
+ *  Loads a script that is already in memory using the workers of pool.
+ */
+void Parser::loadText(const char *begin, const char *end, ThreadPool &pool){
+    std::vector<Object*> objects;
+    parseChunks(begin, end, pool, objects);
+    universe().addObjects(objects);
+}
+
+/**
+ *  Reads the script file in blocks of blockSize bytes and registers the
+ *  bodies of every block with the Universe before reading the next one.
+ */
+void Parser::streamFile(const char *filename, const Progress &progress, size_t blockSize){
+    std::unique_ptr<std::FILE, int (*)(std::FILE *)> file(std::fopen(filename, "rb"), &std::fclose);
+    if (!file)
+        throw std::runtime_error(std::string("Unable to open ") + filename);
+
+    Universe &target = universe();
+    std::vector<char> block(std::max<size_t>(blockSize, 1));
+    std::vector<Object*> objects;
+    size_t used = 0;
+    size_t line = 1;
+    size_t bodies = 0;
+    size_t bytes = 0;
+
+    try {
+        bool done = false;
+        while (!done){
+            // Only a line longer than the whole block makes it grow.
+            if (used == block.size())
+                block.resize(2 * block.size());
+
+            const size_t read = std::fread(block.data() + used, 1, block.size() - used, file.get());
+            if (read == 0 && std::ferror(file.get()))
+                throw std::runtime_error("read error");
+            done = read == 0;
+            used += read;
+            bytes += read;
+
+            // Parse up to the last complete line; the rest is moved to the
+            // front of the block and completed by the next read.
+            const char *begin = block.data();
+            const char *complete = begin + used;
+            if (!done){
+                while (complete != begin && complete[-1] != '\n')
+                    --complete;
+                if (complete == begin)
+                    continue;
+            }
+
+            parseLines(begin, complete, line, objects);
+            line += countLines(begin, complete);
+            bodies += objects.size();
+            target.addObjects(objects);
+
+            used = begin + used - complete;
+            std::memmove(block.data(), complete, used);
+
+            if (progress)
+                progress(bodies, bytes);
+        }
+    } catch (const std::runtime_error &error){
+        throw std::runtime_error(std::string(filename) + ": " + error.what());
+    }
+}
+
+/**
+ *  Marks every character of delims() as well as tabs and carriage returns as
+ *  field separators.
+ */
+Parser::Delimiters::Delimiters() : table_(){
+    for (const char *c = delims(); *c; ++c)
+        table_[static_cast<unsigned char>(*c)] = true;
+    table_[static_cast<unsigned char>('\t')] = true;
+    table_[static_cast<unsigned char>('\r')] = true;
+}
+
+/**
+ *  Returns true if c separates fields.
+ */
+bool Parser::isDelimiter(char c){
+    static const Delimiters delimiters;
+    return delimiters.contains(c);
+}
+
+/**
+ *  Parses every line of [begin, end) and appends the bodies to objects.
+ */
+void Parser::parseLines(const char *begin, const char *end, size_t firstLine,
+                        std::vector<Object*> &objects){
+    try {
+        size_t line = firstLine;
+        while (begin != end){
+            const char *newline = static_cast<const char *>(std::memchr(begin, '\n', end - begin));
+            const char *lineEnd = newline ? newline : end;
+            parseLine(begin, lineEnd, line++, objects);
+            begin = newline ? newline + 1 : end;
+        }
+    } catch (...){
+        for (Object *object : objects)
+            delete object;
+        objects.clear();
+        throw;
+    }
+}
+
+/**
+ *  Parses [begin, end) in chunks of whole lines on the workers of pool and
+ *  appends the bodies to objects in file order.
+ */
+void Parser::parseChunks(const char *begin, const char *end, ThreadPool &pool,
+                         std::vector<Object*> &objects){
+    const size_t size = end - begin;
+    // A few chunks per worker even out lines of different lengths.
+    const size_t chunkCount = std::min(pool.size() * 4, size / minChunkSize);
+    if (chunkCount <= 1){
+        parseLines(begin, end, 1, objects);
+        return;
+    }
+
+    // Every chunk but the first starts just after a newline.
+    std::vector<const char *> bounds(1, begin);
+    for (size_t i = 1; i < chunkCount; i++){
+        const char *split = std::max(begin + size / chunkCount * i, bounds.back());
+        const char *newline = static_cast<const char *>(std::memchr(split, '\n', end - split));
+        bounds.push_back(newline ? newline + 1 : end);
+    }
+    bounds.push_back(end);
+
+    // Line numbers are unknown until the preceding chunks have been read, so
+    // the chunks report failure and the first bad one is parsed again below
+    // for the error message.
+    std::vector<std::vector<Object*> > parsed(chunkCount);
+    std::vector<std::exception_ptr> errors(chunkCount);
+    ThreadPool::Batch batch(pool);
+    for (size_t i = 0; i < chunkCount; i++)
+        batch.submit([&, i]() {
+            try {
+                parseLines(bounds[i], bounds[i + 1], 1, parsed[i]);
+            } catch (...){
+                errors[i] = std::current_exception();
+            }
+        });
+    batch.wait();
+
+    size_t total = 0;
+    size_t failed = chunkCount;
+    for (size_t i = 0; i < chunkCount; i++){
+        total += parsed[i].size();
+        if (errors[i] && failed == chunkCount)
+            failed = i;
+    }
+
+    if (failed < chunkCount){
+        for (std::vector<Object*> &chunk : parsed)
+            for (Object *object : chunk)
+                delete object;
+
+        std::vector<Object*> retry;
+        parseLines(bounds[failed], bounds[failed + 1], 1 + countLines(begin, bounds[failed]), retry);
+        // Only reached if the chunk failed for a reason other than its text.
+        for (Object *object : retry)
+            delete object;
+        std::rethrow_exception(errors[failed]);
+    }
+
+    objects.reserve(objects.size() + total);
+    for (const std::vector<Object*> &chunk : parsed)
+        objects.insert(objects.end(), chunk.begin(), chunk.end());
+}
+
+/**
+ *  Returns the number of newlines in [begin, end).
+ */
+size_t Parser::countLines(const char *begin, const char *end){
+    size_t count = 0;
+    while ((begin = static_cast<const char *>(std::memchr(begin, '\n', end - begin)))){
+        count++;
+        begin++;
+    }
+    return count;
+}
+
+/**
+ *  Parses the fields of a single line and appends the body, if any, to
+ *  objects.
+ */
+void Parser::parseLine(const char *begin, const char *end, size_t line,
+                       std::vector<Object*> &objects){
+    const char *cursor = skipDelimiters(begin, end);
+    // Blank lines are allowed anywhere.
+    if (cursor == end)
+        return;
+
+    const char *name = cursor;
+    cursor = skipField(cursor, end);
+    const char *nameEnd = cursor;
+
+    // The numbers are converted as they are scanned, so every character of
+    // the line is only read once.
+    const size_t numberCount = 5;
+    double values[numberCount];
+    for (size_t i = 0; i < numberCount; i++){
+        cursor = skipDelimiters(cursor, end);
+        if (cursor == end)
+            throw std::runtime_error("line " + std::to_string(line) + ": expected "
+                                     + "{name, mass, [x y], [vx vy]}");
+        cursor = getDouble(cursor, end, line, values[i]);
+    }
+
+    if (skipDelimiters(cursor, end) != end)
+        throw std::runtime_error("line " + std::to_string(line) + ": too many fields");
+
+    vector2 position, velocity;
+    position[0] = values[1];
+    position[1] = values[2];
+    velocity[0] = values[3];
+    velocity[1] = values[4];
+
+    objects.push_back(ObjectFactory::makeObject(std::string(name, nameEnd), values[0],
+                                                position, velocity));
+}
+
+/**
+ *  Returns the first character at or after begin that is not a delimiter.
+ */
+const char * Parser::skipDelimiters(const char *begin, const char *end){
+    while (begin != end && isDelimiter(*begin))
+        ++begin;
+    return begin;
+}
+
+/**
+ *  Returns the first delimiter at or after begin.
+ */
+const char * Parser::skipField(const char *begin, const char *end){
+    while (begin != end && !isDelimiter(*begin))
+        ++begin;
+    return begin;
+}
+
+/**
+ *  Converts the number at the start of the field beginning at begin.
+ */
+const char * Parser::getDouble(const char *begin, const char *end, size_t line, double &value){
+    // Powers of ten that are exactly representable as doubles.
+    static const double powers[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    const int maxPower = 22;
+    const uint64_t maxExact = uint64_t(1) << 53;
+    const long maxDigits = 19;
+
+    const char *cursor = begin;
+    bool negative = false;
+    if (cursor != end && (*cursor == '-' || *cursor == '+'))
+        negative = *cursor++ == '-';
+
+    // Collect the digits as an integer and the position of the decimal point
+    // as a power of ten. More than 19 digits may overflow and are left to
+    // strtod.
+    uint64_t significand = 0;
+    const char *digits = cursor;
+    while (cursor != end && unsigned(*cursor - '0') < 10)
+        significand = significand * 10 + (*cursor++ - '0');
+    long count = cursor - digits;
+
+    long exponent = 0;
+    if (cursor != end && *cursor == '.'){
+        const char *fraction = ++cursor;
+        while (cursor != end && unsigned(*cursor - '0') < 10)
+            significand = significand * 10 + (*cursor++ - '0');
+        exponent = fraction - cursor;
+        count += cursor - fraction;
+    }
+
+    if (count > 0 && cursor != end && (*cursor == 'e' || *cursor == 'E')){
+        const char *mark = cursor++;
+        bool negativeExponent = false;
+        if (cursor != end && (*cursor == '-' || *cursor == '+'))
+            negativeExponent = *cursor++ == '-';
+
+        const char *written = cursor;
+        long power = 0;
+        // Anything this large over- or underflows anyway.
+        while (cursor != end && unsigned(*cursor - '0') < 10 && power < 100000)
+            power = power * 10 + (*cursor++ - '0');
+        if (cursor == written)
+            cursor = mark;
+        exponent += negativeExponent ? -power : power;
+    }
+
+    // Clinger's fast path: the significand and the power of ten are exact, so
+    // a single correctly rounded operation gives the correctly rounded
+    // result. Excess precision (x87) would round twice, so it is skipped
+    // there.
+#if FLT_EVAL_METHOD == 0
+    const bool complete = cursor == end || isDelimiter(*cursor);
+    if (complete && count > 0 && count <= maxDigits && significand <= maxExact){
+        if (exponent < 0 && exponent >= -maxPower){
+            value = double(significand) / powers[-exponent];
+            value = negative ? -value : value;
+            return cursor;
+        }
+        // e.g. 1.98892e30: move the excess into the significand while it
+        // stays exact.
+        while (exponent > maxPower && significand <= maxExact / 10){
+            significand *= 10;
+            exponent--;
+        }
+        if (exponent >= 0 && exponent <= maxPower){
+            value = double(significand) * powers[exponent];
+            value = negative ? -value : value;
+            return cursor;
+        }
+    }
+#endif
+
+    const char *fieldEnd = skipField(cursor, end);
+    value = getDoubleExactly(begin, fieldEnd, line);
+    return fieldEnd;
+}
+
+/**
+ *  Returns the number spelled by the field [begin, end) as converted by
+ *  strtod.
+ */
+double Parser::getDoubleExactly(const char *begin, const char *end, size_t line){
+    // strtod needs a null terminated string.
+    char buffer[64];
+    std::string copy;
+    const size_t length = end - begin;
+    const char *text = buffer;
+    if (length < sizeof(buffer)){
+        std::memcpy(buffer, begin, length);
+        buffer[length] = '\0';
+    } else {
+        copy.assign(begin, end);
+        text = copy.c_str();
+    }
+
+    char *parsed = nullptr;
+    double value = std::strtod(text, &parsed);
+    if (length == 0 || parsed != text + length)
+        throw std::runtime_error("line " + std::to_string(line) + ": '"
+                                 + std::string(begin, end) + "' is not a number");
+    return value;
+}
+
+/**
+ *  Returns the Universe to configure.
+ */
+Universe & Parser::universe() const{
+    return universe_ ? *universe_ : *Universe::instance();
 }
 
 #endif
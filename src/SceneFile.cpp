@@ -0,0 +1,201 @@
+/**
+ * @class SceneFile.cpp
+ * @brief Binary scene format
+ * @details Writes the bodies of a Universe as columns of raw doubles and maps
+ * such files back in without any parsing
+ *
+ * I affirm that this work is my own
+ * 2016-11-30
+ * @author Edward Goode
+ * VuID: goodees
+ * Email: edward.s.goode@vanderbilt.edu
+ */
+
+#ifndef _SCENE_FILE_CPP_
+#define _SCENE_FILE_CPP_
+
+#include "../include/SceneFile.h"
+#include "../include/BinaryFormat.h"
+#include "../include/Object.h"
+#include "../include/ObjectFactory.h"
+#include "../include/Universe.h"
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+const uint32_t SceneFile::version;
+
+/**
+ *  Computes the offsets of the sections of a file with count bodies and
+ *  namesSize bytes of names.
+ */
+SceneFile::Layout::Layout(uint64_t count, uint64_t namesSize){
+    const uint64_t real = sizeof(double);
+    nameOffsets = sizeof(Header);
+    names = nameOffsets + (count + 1) * sizeof(uint64_t);
+    masses = names + namesSize + BinaryFormat::padding(namesSize);
+    positions = masses + count * real;
+    velocities = positions + 2 * count * real;
+    end = velocities + 2 * count * real;
+}
+
+/**
+ *  Maps filename and checks that it is a complete scene file.
+ */
+SceneFile::SceneFile(const char *filename) : file_(filename), count_(0), layout_(0, 0){
+    const std::string name(filename);
+    const Header expected = makeHeader();
+    BinaryFormat::checkHeader(file_, sizeof(Header), expected.magic, version, name, "scene file");
+    Header header;
+    std::memcpy(&header, file_.begin(), sizeof(Header));
+    if (header.dimensions != 2)
+        throw std::runtime_error(name + ": scene is not two dimensional");
+
+    // The name table bounds the body count, so the layout cannot overflow.
+    BinaryFormat::checkNames(file_, sizeof(Header), header.count, header.namesSize, name, "scene file");
+    layout_ = Layout(header.count, header.namesSize);
+    if (layout_.end > file_.size())
+        throw std::runtime_error(name + ": truncated scene file");
+    count_ = header.count;
+}
+
+/**
+ *  Writes the bodies of universe to filename.
+ */
+void SceneFile::write(const char *filename, const Universe &universe){
+    Header header = makeHeader();
+    std::vector<uint64_t> offsets(1, 0);
+    std::string names;
+    std::vector<double> columns[5];
+    for (Universe::const_iterator i = universe.begin(); i != universe.end(); ++i){
+        const Object &object = **i;
+        names += object.getName();
+        offsets.push_back(names.size());
+
+        const vector2 position = object.getPosition();
+        const vector2 velocity = object.getVelocity();
+        columns[0].push_back(object.getMass());
+        columns[1].push_back(position[0]);
+        columns[2].push_back(position[1]);
+        columns[3].push_back(velocity[0]);
+        columns[4].push_back(velocity[1]);
+    }
+    header.count = offsets.size() - 1;
+    header.dimensions = 2;
+    header.namesSize = names.size();
+    const Layout layout(header.count, header.namesSize);
+    names.resize(layout.masses - layout.names, '\0');
+
+    std::unique_ptr<std::FILE, int (*)(std::FILE *)> file(std::fopen(filename, "wb"), &std::fclose);
+    if (!file)
+        throw std::runtime_error(std::string("Unable to open ") + filename);
+
+    bool written = std::fwrite(&header, sizeof(header), 1, file.get()) == 1
+        && std::fwrite(offsets.data(), sizeof(uint64_t), offsets.size(), file.get()) == offsets.size()
+        && std::fwrite(names.data(), 1, names.size(), file.get()) == names.size();
+    for (const std::vector<double> &column : columns)
+        written = written && std::fwrite(column.data(), sizeof(double), column.size(), file.get()) == column.size();
+
+    if (!written || std::fclose(file.release()) != 0)
+        throw std::runtime_error(std::string("Unable to write ") + filename);
+}
+
+/**
+ *  Returns true if filename starts like a scene file.
+ */
+bool SceneFile::isSceneFile(const char *filename){
+    std::unique_ptr<std::FILE, int (*)(std::FILE *)> file(std::fopen(filename, "rb"), &std::fclose);
+    char magic[sizeof(Header::magic)];
+    return file && std::fread(magic, sizeof(magic), 1, file.get()) == 1
+        && std::memcmp(magic, makeHeader().magic, sizeof(magic)) == 0;
+}
+
+/**
+ *  Returns the number of bodies.
+ */
+size_t SceneFile::size() const{
+    return count_;
+}
+
+/**
+ *  Returns the name of body.
+ */
+std::string SceneFile::getName(size_t body) const{
+    uint64_t range[2];
+    std::memcpy(range, file_.begin() + layout_.nameOffsets + body * sizeof(uint64_t), sizeof(range));
+    const char *names = file_.begin() + layout_.names;
+    return std::string(names + range[0], names + range[1]);
+}
+
+/**
+ *  Returns the masses of all bodies.
+ */
+const double * SceneFile::masses() const{
+    return column(layout_.masses);
+}
+
+/**
+ *  Returns component d of the positions of all bodies.
+ */
+const double * SceneFile::positions(size_t d) const{
+    return column(layout_.positions + d * count_ * sizeof(double));
+}
+
+/**
+ *  Returns component d of the velocities of all bodies.
+ */
+const double * SceneFile::velocities(size_t d) const{
+    return column(layout_.velocities + d * count_ * sizeof(double));
+}
+
+/**
+ *  Registers a new Object for every body with universe, in order.
+ */
+void SceneFile::addTo(Universe &universe) const{
+    const double *mass = masses();
+    const double *x = positions(0);
+    const double *y = positions(1);
+    const double *vx = velocities(0);
+    const double *vy = velocities(1);
+
+    std::vector<Object*> objects;
+    objects.reserve(count_);
+    try {
+        for (size_t i = 0; i < count_; i++){
+            vector2 position, velocity;
+            position[0] = x[i];
+            position[1] = y[i];
+            velocity[0] = vx[i];
+            velocity[1] = vy[i];
+            objects.push_back(ObjectFactory::makeObject(getName(i), mass[i], position, velocity));
+        }
+    } catch (...){
+        for (Object *object : objects)
+            delete object;
+        throw;
+    }
+    universe.addObjects(objects);
+}
+
+/**
+ *  Returns header with the magic, byte order mark and version filled in.
+ */
+SceneFile::Header SceneFile::makeHeader(){
+    Header header = Header();
+    std::memcpy(header.magic, "NBSCENE", sizeof(header.magic));
+    header.byteOrder = BinaryFormat::byteOrderMark;
+    header.version = version;
+    return header;
+}
+
+/**
+ *  Returns the column of count doubles starting at offset. The mapping is
+ *  page aligned and every column starts at a multiple of 8 bytes.
+ */
+const double * SceneFile::column(uint64_t offset) const{
+    return reinterpret_cast<const double *>(file_.begin() + offset);
+}
+
+#endif
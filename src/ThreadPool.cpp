@@ -0,0 +1,187 @@
+/**
+ * @class ThreadPool.cpp
+ * @brief A fixed-size pool of worker threads
+ * @details Shared by the ensemble runner and every other parallel driver
+ *
+ * I affirm that this work is my own
+ * 2016-11-30
+ * @author Edward Goode
+ * VuID: goodees
+ * Email: edward.s.goode@vanderbilt.edu
+ */
+
+#ifndef _THREAD_POOL_CPP_
+#define _THREAD_POOL_CPP_
+
+#include "../include/ThreadPool.h"
+
+/**
+ *  Starts threads workers. Zero selects one worker per hardware thread.
+ */
+ThreadPool::ThreadPool(size_t threads) : active_(0), stopping_(false){
+    if (threads == 0)
+        threads = std::thread::hardware_concurrency();
+
+    // hardware_concurrency() may report zero when it cannot tell.
+    if (threads == 0)
+        threads = 1;
+
+    for (size_t i = 0; i < threads; i++)
+        workers_.push_back(std::thread(&ThreadPool::work, this));
+}
+
+/**
+ *  Finishes every queued task and joins the workers.
+ */
+ThreadPool::~ThreadPool(){
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    available_.notify_all();
+
+    for (std::thread &worker : workers_)
+        worker.join();
+}
+
+/**
+ *  Queues task for execution on one of the workers.
+ */
+void ThreadPool::submit(const std::function<void()> &task){
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push(task);
+    }
+    available_.notify_one();
+}
+
+/**
+ *  Blocks until every submitted task, including those of other clients, has
+ *  finished. If any task submitted outside a Batch threw, the first such
+ *  exception is rethrown here.
+ */
+void ThreadPool::wait(){
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_.wait(lock, [this]() { return tasks_.empty() && active_ == 0; });
+
+    if (error_){
+        std::exception_ptr error = error_;
+        error_ = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+/**
+ *  Returns the number of worker threads.
+ */
+size_t ThreadPool::size() const{
+    return workers_.size();
+}
+
+/**
+ *  Body of each worker thread.
+ */
+void ThreadPool::work(){
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (true){
+        available_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+        if (tasks_.empty())
+            return;
+
+        runNext(lock);
+    }
+}
+
+/**
+ *  Takes the first queued task and runs it with lock released.
+ */
+void ThreadPool::runNext(std::unique_lock<std::mutex> &lock){
+    std::function<void()> task = tasks_.front();
+    tasks_.pop();
+    active_++;
+    lock.unlock();
+
+    try {
+        task();
+    } catch (...) {
+        lock.lock();
+        if (!error_)
+            error_ = std::current_exception();
+        lock.unlock();
+    }
+
+    lock.lock();
+    active_--;
+    if (tasks_.empty() && active_ == 0)
+        idle_.notify_all();
+}
+
+/**
+ *  Creates an empty batch of tasks for pool.
+ */
+ThreadPool::Batch::Batch(ThreadPool &pool) : pool_(pool), pending_(0){
+}
+
+/**
+ *  Waits for the tasks of the batch, discarding their exceptions.
+ */
+ThreadPool::Batch::~Batch(){
+    try {
+        wait();
+    } catch (...) {
+    }
+}
+
+/**
+ *  Queues task on the pool as part of this batch.
+ */
+void ThreadPool::Batch::submit(const std::function<void()> &task){
+    {
+        std::lock_guard<std::mutex> lock(pool_.mutex_);
+        pending_++;
+    }
+
+    pool_.submit([this, task]() {
+        std::exception_ptr error;
+        try {
+            task();
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        // The batch may be destroyed as soon as pending_ reaches zero, so
+        // it is not touched after the lock is released.
+        std::lock_guard<std::mutex> lock(pool_.mutex_);
+        if (error && !error_)
+            error_ = error;
+        if (--pending_ == 0)
+            pool_.idle_.notify_all();
+    });
+}
+
+/**
+ *  Blocks until every task of the batch has finished, running queued tasks
+ *  of the pool meanwhile.
+ */
+void ThreadPool::Batch::wait(){
+    std::unique_lock<std::mutex> lock(pool_.mutex_);
+
+    // Helping with the queue keeps a waiting worker from starving the tasks
+    // it waits for. Once the queue is empty, every pending task is running
+    // and will signal when it finishes.
+    while (pending_ != 0){
+        if (!pool_.tasks_.empty())
+            pool_.runNext(lock);
+        else
+            pool_.idle_.wait(lock);
+    }
+
+    if (error_){
+        std::exception_ptr error = error_;
+        error_ = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+#endif
@@ -0,0 +1,274 @@
+/**
+ * @class TrajectoryCodec.cpp
+ * @brief Lossless compression of trajectory columns
+ * @details Polynomial extrapolation of the bit patterns of the values with
+ *          zigzag coded residuals of variable length
+ *
+ * I affirm that this work is my own
+ * 2016-11-30
+ * @author Edward Goode
+ * VuID: goodees
+ * Email: edward.s.goode@vanderbilt.edu
+ */
+
+#ifndef _TRAJECTORY_CODEC_CPP_
+#define _TRAJECTORY_CODEC_CPP_
+
+#include "../include/TrajectoryCodec.h"
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define TRAJECTORY_CODEC_LITTLE_ENDIAN 1
+#endif
+
+const unsigned TrajectoryCodec::maxOrder;
+
+/**
+ *  Appends the encoded count words of values to out.
+ */
+void TrajectoryCodec::encode(const uint64_t *values, size_t count, std::vector<char> &out){
+    encodeWords(values, count, out);
+}
+
+/**
+ *  Appends the encoded bit patterns of count doubles to out.
+ */
+void TrajectoryCodec::encode(const double *values, size_t count, std::vector<char> &out){
+    encodeWords(values, count, out);
+}
+
+/**
+ *  Decodes count words from the stream in [begin, end) into values.
+ */
+const char * TrajectoryCodec::decode(const char *begin, const char *end, size_t count, uint64_t *values){
+    return decodeWords(begin, end, count, values);
+}
+
+/**
+ *  Decodes count doubles from the stream in [begin, end) into values.
+ */
+const char * TrajectoryCodec::decode(const char *begin, const char *end, size_t count, double *values){
+    return decodeWords(begin, end, count, values);
+}
+
+/**
+ *  Replaces payload with the compressed payload of a chunk.
+ */
+void TrajectoryCodec::encodeChunk(size_t count, size_t columns, const uint64_t *steps, const double *times,
+                                  const double *values, std::vector<char> &payload){
+    const size_t streams = 2 + columns;
+    const size_t offsetBytes = (streams + 1) * sizeof(uint64_t);
+    std::vector<uint64_t> offsets(streams + 1, 0);
+
+    payload.assign(offsetBytes, 0);
+    for (size_t stream = 0; stream < streams; stream++){
+        offsets[stream] = payload.size() - offsetBytes;
+        if (stream == 0)
+            encode(steps, count, payload);
+        else if (stream == 1)
+            encode(times, count, payload);
+        else
+            encode(values + (stream - 2) * count, count, payload);
+    }
+    offsets[streams] = payload.size() - offsetBytes;
+    std::memcpy(payload.data(), offsets.data(), offsetBytes);
+    payload.resize(payload.size() + (8 - payload.size() % 8) % 8, 0);
+}
+
+/**
+ *  Decodes the steps of a compressed payload.
+ */
+void TrajectoryCodec::decodeStream(const char *payload, size_t size, size_t count, size_t columns,
+                                   size_t stream, uint64_t *values){
+    decodeStreamWords(payload, size, count, columns, stream, values);
+}
+
+/**
+ *  Decodes the times or a column of a compressed payload.
+ */
+void TrajectoryCodec::decodeStream(const char *payload, size_t size, size_t count, size_t columns,
+                                   size_t stream, double *values){
+    decodeStreamWords(payload, size, count, columns, stream, values);
+}
+
+/**
+ *  Decodes a whole compressed payload into the layout of a raw one.
+ */
+void TrajectoryCodec::decodeChunk(const char *payload, size_t size, size_t count, size_t columns,
+                                  uint64_t *steps, double *times, double *values){
+    decodeStream(payload, size, count, columns, 0, steps);
+    decodeStream(payload, size, count, columns, 1, times);
+    for (size_t k = 0; k < columns; k++)
+        decodeStream(payload, size, count, columns, 2 + k, values + k * count);
+}
+
+/**
+ *  Appends the encoded bit patterns of count words of type T.
+ */
+template <typename T>
+void TrajectoryCodec::encodeWords(const T *values, size_t count, std::vector<char> &out){
+    std::vector<uint64_t> words(count);
+    if (count != 0)
+        std::memcpy(words.data(), values, count * sizeof(uint64_t));
+
+    // Pick the order with the fewest residual bytes; the header bytes cost
+    // the same for every order.
+    unsigned best = 0;
+    size_t bestBytes = 0;
+    for (unsigned order = 0; order <= maxOrder; order++){
+        size_t bytes = 0;
+        for (size_t i = 0; i < count; i++){
+            const unsigned known = i < order ? unsigned(i) : order;
+            bytes += residualBytes(words[i] - predict(known, &words[i]));
+        }
+        if (order == 0 || bytes < bestBytes){
+            best = order;
+            bestBytes = bytes;
+        }
+    }
+
+    out.reserve(out.size() + 1 + (count + 1) / 2 + bestBytes);
+    out.push_back(char(best));
+    size_t header = 0;
+    for (size_t i = 0; i < count; i++){
+        const unsigned known = i < best ? unsigned(i) : best;
+        const uint64_t difference = words[i] - predict(known, &words[i]);
+        const uint64_t residual = (difference << 1) ^ (0 - (difference >> 63));
+        const unsigned bytes = residualBytes(difference);
+
+        if (i % 2 == 0){
+            header = out.size();
+            out.push_back(char(bytes));
+        } else {
+            out[header] = char(out[header] | (bytes << 4));
+        }
+        for (unsigned b = 0; b < bytes; b++)
+            out.push_back(char(residual >> (8 * b)));
+    }
+}
+
+/**
+ *  Decodes count words into the bit patterns of values of type T.
+ */
+template <typename T>
+const char * TrajectoryCodec::decodeWords(const char *begin, const char *end, size_t count, T *values){
+    const unsigned char *p = reinterpret_cast<const unsigned char *>(begin);
+    const unsigned char *last = reinterpret_cast<const unsigned char *>(end);
+    if (p == last)
+        throw std::runtime_error("Corrupt trajectory stream: missing order");
+    const unsigned order = *p++;
+    if (order > maxOrder)
+        throw std::runtime_error("Corrupt trajectory stream: unknown order " + std::to_string(order));
+
+#if defined(TRAJECTORY_CODEC_LITTLE_ENDIAN)
+    static const uint64_t masks[sizeof(uint64_t) + 1] = {
+            0, 0xff, 0xffff, 0xffffff, 0xffffffffULL, 0xffffffffffULL, 0xffffffffffffULL,
+            0xffffffffffffffULL, ~0ULL};
+#endif
+
+    unsigned header = 0;
+    for (size_t i = 0; i < count; i++){
+        if (i % 2 == 0){
+            if (p == last)
+                throw std::runtime_error("Corrupt trajectory stream: truncated");
+            header = *p++;
+        } else {
+            header >>= 4;
+        }
+        const unsigned bytes = header & 0xf;
+        if (bytes > sizeof(uint64_t))
+            throw std::runtime_error("Corrupt trajectory stream: residual of " + std::to_string(bytes) + " bytes");
+        if (size_t(last - p) < bytes)
+            throw std::runtime_error("Corrupt trajectory stream: truncated");
+
+        uint64_t residual = 0;
+#if defined(TRAJECTORY_CODEC_LITTLE_ENDIAN)
+        if (size_t(last - p) >= sizeof(uint64_t)){
+            // Away from the end, load 8 bytes at once and drop the excess.
+            std::memcpy(&residual, p, sizeof(residual));
+            residual &= masks[bytes];
+        } else {
+            for (unsigned b = 0; b < bytes; b++)
+                residual |= uint64_t(p[b]) << (8 * b);
+        }
+#else
+        for (unsigned b = 0; b < bytes; b++)
+            residual |= uint64_t(p[b]) << (8 * b);
+#endif
+        p += bytes;
+
+        const unsigned known = i < order ? unsigned(i) : order;
+        const uint64_t word = predict(known, values + i) + ((residual >> 1) ^ (0 - (residual & 1)));
+        std::memcpy(values + i, &word, sizeof(word));
+    }
+    return reinterpret_cast<const char *>(p);
+}
+
+/**
+ *  Decodes stream of a compressed payload into values of type T.
+ */
+template <typename T>
+void TrajectoryCodec::decodeStreamWords(const char *payload, size_t size, size_t count, size_t columns,
+                                        size_t stream, T *values){
+    const size_t streams = 2 + columns;
+    const size_t offsetBytes = (streams + 1) * sizeof(uint64_t);
+    if (stream >= streams)
+        throw std::invalid_argument("Trajectory chunks have no stream " + std::to_string(stream));
+    if (size < offsetBytes)
+        throw std::runtime_error("Corrupt trajectory chunk: truncated");
+
+    uint64_t begin, end;
+    std::memcpy(&begin, payload + stream * sizeof(uint64_t), sizeof(begin));
+    std::memcpy(&end, payload + (stream + 1) * sizeof(uint64_t), sizeof(end));
+    if (begin > end || end > size - offsetBytes)
+        throw std::runtime_error("Corrupt trajectory chunk: bad stream offsets");
+
+    const char *data = payload + offsetBytes;
+    if (decodeWords(data + begin, data + end, count, values) != data + end)
+        throw std::runtime_error("Corrupt trajectory chunk: stream " + std::to_string(stream)
+                                 + " has trailing bytes");
+}
+
+/**
+ *  Returns the prediction of order for the word at next.
+ */
+template <typename T>
+uint64_t TrajectoryCodec::predict(unsigned order, const T *next){
+    // The signed binomial coefficients of the differences of each order. The
+    // arithmetic wraps, so the prediction is exact whatever the words are.
+    static const int64_t coefficients[maxOrder + 1][maxOrder] = {
+            {0, 0, 0, 0, 0, 0, 0},
+            {1, 0, 0, 0, 0, 0, 0},
+            {2, -1, 0, 0, 0, 0, 0},
+            {3, -3, 1, 0, 0, 0, 0},
+            {4, -6, 4, -1, 0, 0, 0},
+            {5, -10, 10, -5, 1, 0, 0},
+            {6, -15, 20, -15, 6, -1, 0},
+            {7, -21, 35, -35, 21, -7, 1}};
+
+    uint64_t prediction = 0;
+    for (unsigned j = 0; j < order; j++){
+        uint64_t word;
+        std::memcpy(&word, next - 1 - j, sizeof(word));
+        prediction += uint64_t(coefficients[order][j]) * word;
+    }
+    return prediction;
+}
+
+/**
+ *  Returns the number of bytes of the zigzag coded difference without its
+ *  leading zero bytes.
+ */
+unsigned TrajectoryCodec::residualBytes(uint64_t difference){
+    uint64_t residual = (difference << 1) ^ (0 - (difference >> 63));
+    unsigned bytes = 0;
+    while (residual != 0){
+        residual >>= 8;
+        bytes++;
+    }
+    return bytes;
+}
+
+#endif
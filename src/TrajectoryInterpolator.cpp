@@ -0,0 +1,133 @@
+/**
+ * @class TrajectoryInterpolator.cpp
+ * @brief Dense output of recorded trajectories
+ * @details Cubic Hermite interpolation between the samples of a trajectory
+ *          file, with an error estimate from the change of the third
+ *          derivative between neighbouring intervals
+ *
+ * I affirm that this work is my own
+ * 2016-11-30
+ * @author Edward Goode
+ * VuID: goodees
+ * Email: edward.s.goode@vanderbilt.edu
+ */
+
+#ifndef _TRAJECTORY_INTERPOLATOR_CPP_
+#define _TRAJECTORY_INTERPOLATOR_CPP_
+
+#include "../include/TrajectoryInterpolator.h"
+#include "../include/TrajectoryRecorder.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+/**
+ *  Interpolates the trajectory of reader.
+ */
+TrajectoryInterpolator::TrajectoryInterpolator(const TrajectoryReader &reader)
+        : reader_(&reader), interval_(0){
+    window_.first = 0;
+}
+
+/**
+ *  Replaces states with the states of bodies at time.
+ */
+void TrajectoryInterpolator::interpolate(double time, const std::vector<size_t> &bodies,
+                                         std::vector<State> &states){
+    // Reuse the loaded window while time stays within its interval.
+    size_t k = interval_ - window_.first;
+    if (window_.size() < 2 || window_.bodies != bodies || !(window_.times[k] <= time)
+            || !(time <= window_.times[k + 1])){
+        const size_t count = reader_->getSampleCount();
+        const size_t next = reader_->findSample(time);
+        if (count == 0 || next == count || std::isnan(time))
+            throw std::invalid_argument("No samples at time " + std::to_string(time));
+        load(next == 0 || count == 1 ? 0 : next - 1, bodies);
+        k = interval_ - window_.first;
+        if (time < window_.times[k] || (count == 1 && time != window_.times[k]))
+            throw std::invalid_argument("No samples at time " + std::to_string(time));
+    }
+
+    states.resize(bodies.size());
+    if (window_.size() == 1){
+        for (size_t b = 0; b < bodies.size(); b++){
+            states[b].position = get(0, b, 0);
+            states[b].velocity = get(0, b, 2);
+            states[b].error = 0.0;
+        }
+        return;
+    }
+
+    const double t0 = window_.times[k];
+    const double h = window_.times[k + 1] - t0;
+    const double s = h > 0 ? (time - t0) / h : 0.0;
+    const double r = 1 - s;
+    // Weight of the fourth derivative in the error, zero at the samples.
+    const double weight = s * s * r * r * h * h * h * h / 24;
+
+    for (size_t b = 0; b < bodies.size(); b++){
+        const vector2 p0 = get(k, b, 0), v0 = get(k, b, 2);
+        const vector2 p1 = get(k + 1, b, 0), v1 = get(k + 1, b, 2);
+        State &state = states[b];
+        state.position = (1 + 2 * s) * r * r * p0 + h * s * r * r * v0 + s * s * (3 - 2 * s) * p1
+                         - h * s * s * r * v1;
+        state.velocity = h > 0 ? vector2(6 * s * (s - 1) / h * (p0 - p1) + r * (1 - 3 * s) * v0
+                                         + s * (3 * s - 2) * v1)
+                               : v0;
+
+        if (weight == 0){
+            state.error = 0.0;
+            continue;
+        }
+        double fourth[2] = {-1.0, -1.0};
+        const vector2 third = thirdDerivative(k, b);
+        for (size_t j = k == 0 ? k + 1 : k - 1; j <= k + 1 && j + 1 < window_.size(); j += 2){
+            const double span = (window_.times[j + 1] - window_.times[j] + h) / 2;
+            const vector2 neighbour = thirdDerivative(j, b);
+            for (size_t c = 0; c < 2; c++)
+                fourth[c] = std::max(fourth[c], std::fabs(neighbour[c] - third[c]) / span);
+        }
+        state.error = fourth[0] < 0 ? std::numeric_limits<double>::infinity()
+                                    : weight * std::hypot(fourth[0], fourth[1]);
+    }
+}
+
+/**
+ *  Reads the samples around the interval from sample to sample + 1.
+ */
+void TrajectoryInterpolator::load(size_t sample, const std::vector<size_t> &bodies){
+    const size_t count = reader_->getSampleCount();
+    const size_t first = sample == 0 ? 0 : sample - 1;
+    const size_t last = std::min(sample + 2, count - 1);
+    if (window_.size() != 0 && window_.first == first && window_.size() == last - first + 1
+            && window_.bodies == bodies){
+        interval_ = sample;
+        return;
+    }
+    reader_->read(first, last - first + 1, bodies, window_);
+    interval_ = sample;
+}
+
+/**
+ *  Returns the position or velocity of body b at sample of the window.
+ */
+vector2 TrajectoryInterpolator::get(size_t sample, size_t b, size_t offset) const{
+    return vector2(&window_.values[(sample * window_.bodies.size() + b) * TrajectoryRecorder::quantities
+                                   + offset]);
+}
+
+/**
+ *  Returns the third derivative of the interpolant of body b on the interval
+ *  from sample to sample + 1 of the window.
+ */
+vector2 TrajectoryInterpolator::thirdDerivative(size_t sample, size_t b) const{
+    const double h = window_.times[sample + 1] - window_.times[sample];
+    if (!(h > 0))
+        return vector2();
+    return vector2((12 / h * (get(sample, b, 0) - get(sample + 1, b, 0))
+                    + 6.0 * (get(sample, b, 2) + get(sample + 1, b, 2))) / (h * h));
+}
+
+#endif
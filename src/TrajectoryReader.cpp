@@ -0,0 +1,352 @@
+/**
+ * @class TrajectoryReader.cpp
+ * @brief Random access to trajectory files
+ * @details Maps a trajectory file, locates its chunks from the index or the
+ *          chunk headers, and reads windows of samples of selected bodies
+ *
+ * I affirm that this work is my own
+ * 2016-11-30
+ * @author Edward Goode
+ * VuID: goodees
+ * Email: edward.s.goode@vanderbilt.edu
+ */
+
+#ifndef _TRAJECTORY_READER_CPP_
+#define _TRAJECTORY_READER_CPP_
+
+#include "../include/TrajectoryReader.h"
+#include "../include/BinaryFormat.h"
+#include "../include/TrajectoryCodec.h"
+#include "../include/TrajectoryRecorder.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+/**
+ *  Returns the number of samples.
+ */
+size_t TrajectoryReader::Window::size() const{
+    return times.size();
+}
+
+/**
+ *  Opens filename.
+ */
+TrajectoryReader::TrajectoryReader(const char *filename)
+        : filename_(filename), file_(filename, MappedFile::random), bodyCount_(0), interval_(0),
+          indexed_(false){
+    const TrajectoryRecorder::FileHeader expected = TrajectoryRecorder::makeFileHeader();
+    BinaryFormat::checkHeader(file_, sizeof(expected), expected.magic, TrajectoryRecorder::version, filename_,
+                              "trajectory");
+    TrajectoryRecorder::FileHeader header;
+    std::memcpy(&header, file_.begin(), sizeof(header));
+
+    const uint64_t namesEnd = BinaryFormat::readNames(file_, sizeof(header), header.bodyCount, header.namesSize,
+                                                      filename_, "trajectory", nameOffsets_, names_);
+    bodyCount_ = header.bodyCount;
+    interval_ = header.interval;
+    const char *data = file_.begin() + namesEnd;
+    const char *end = file_.end();
+    indexed_ = readIndex(data, end);
+    if (!indexed_)
+        scanChunks(data, end);
+}
+
+/**
+ *  Returns the number of bodies.
+ */
+size_t TrajectoryReader::getBodyCount() const{
+    return bodyCount_;
+}
+
+/**
+ *  Returns the name of body.
+ */
+std::string TrajectoryReader::getName(size_t body) const{
+    if (body >= bodyCount_)
+        throw std::invalid_argument(filename_ + " has no body " + std::to_string(body));
+    return names_.substr(nameOffsets_[body], nameOffsets_[body + 1] - nameOffsets_[body]);
+}
+
+/**
+ *  Returns the first body called name.
+ */
+size_t TrajectoryReader::findBody(const std::string &name) const{
+    for (size_t body = 0; body < bodyCount_; body++)
+        if (nameOffsets_[body + 1] - nameOffsets_[body] == name.size()
+                && names_.compare(nameOffsets_[body], name.size(), name) == 0)
+            return body;
+    throw std::invalid_argument(filename_ + " has no body called " + name);
+}
+
+/**
+ *  Returns the number of samples.
+ */
+size_t TrajectoryReader::getSampleCount() const{
+    return chunks_.empty() ? 0 : chunks_.back().firstSample + chunks_.back().sampleCount;
+}
+
+/**
+ *  Returns the number of steps between samples.
+ */
+size_t TrajectoryReader::getInterval() const{
+    return interval_;
+}
+
+/**
+ *  Returns the number of chunks.
+ */
+size_t TrajectoryReader::getChunkCount() const{
+    return chunks_.size();
+}
+
+/**
+ *  Returns true if the chunks were located by the index of the file.
+ */
+bool TrajectoryReader::isIndexed() const{
+    return indexed_;
+}
+
+/**
+ *  Returns the step of sample.
+ */
+uint64_t TrajectoryReader::getStep(size_t sample) const{
+    const Chunk &chunk = findChunk(sample);
+    uint64_t step;
+    readStream(chunk, 0, sample - chunk.firstSample, 1, &step, 1);
+    return step;
+}
+
+/**
+ *  Returns the time of sample.
+ */
+double TrajectoryReader::getTime(size_t sample) const{
+    const Chunk &chunk = findChunk(sample);
+    double time;
+    readStream(chunk, 1, sample - chunk.firstSample, 1, &time, 1);
+    return time;
+}
+
+/**
+ *  Returns the first sample at or after time.
+ */
+size_t TrajectoryReader::findSample(double time) const{
+    // The index narrows the search to one chunk, whose times are read once.
+    std::vector<Chunk>::const_iterator chunk = std::lower_bound(chunks_.begin(), chunks_.end(), time,
+            [](const Chunk &c, double t) { return c.lastTime < t; });
+    if (chunk == chunks_.end())
+        return getSampleCount();
+
+    std::vector<double> times(chunk->sampleCount);
+    readStream(*chunk, 1, 0, times.size(), times.data(), 1);
+    return chunk->firstSample + (std::lower_bound(times.begin(), times.end(), time) - times.begin());
+}
+
+/**
+ *  Replaces window with the count samples from first on of bodies.
+ */
+void TrajectoryReader::read(size_t first, size_t count, const std::vector<size_t> &bodies,
+                            Window &window) const{
+    if (first > getSampleCount() || count > getSampleCount() - first)
+        throw std::invalid_argument(filename_ + " has no samples " + std::to_string(first) + " to "
+                                    + std::to_string(first + count));
+    for (size_t body : bodies)
+        if (body >= bodyCount_)
+            throw std::invalid_argument(filename_ + " has no body " + std::to_string(body));
+
+    const size_t quantities = TrajectoryRecorder::quantities;
+    const size_t stride = bodies.size() * quantities;
+    window.first = first;
+    window.bodies = bodies;
+    window.steps.resize(count);
+    window.times.resize(count);
+    window.values.resize(count * stride);
+
+    size_t sample = first;
+    while (sample < first + count){
+        const Chunk &chunk = findChunk(sample);
+        const size_t begin = sample - chunk.firstSample;
+        const size_t length = std::min<size_t>(chunk.sampleCount - begin, first + count - sample);
+        const size_t offset = sample - first;
+
+        readStream(chunk, 0, begin, length, &window.steps[offset], 1);
+        readStream(chunk, 1, begin, length, &window.times[offset], 1);
+        for (size_t b = 0; b < bodies.size(); b++)
+            for (size_t q = 0; q < quantities; q++)
+                readStream(chunk, 2 + q * bodyCount_ + bodies[b], begin, length,
+                           &window.values[offset * stride + b * quantities + q], stride);
+        sample += length;
+    }
+}
+
+/**
+ *  Locates the chunks from the index at the end of the file.
+ */
+bool TrajectoryReader::readIndex(const char *begin, const char *end){
+    TrajectoryRecorder::IndexTrailer trailer;
+    if (size_t(end - begin) < sizeof(trailer))
+        return false;
+    std::memcpy(&trailer, end - sizeof(trailer), sizeof(trailer));
+    const TrajectoryRecorder::IndexTrailer expected = TrajectoryRecorder::makeIndexTrailer();
+    if (std::memcmp(trailer.magic, expected.magic, sizeof(trailer.magic)) != 0)
+        return false;
+
+    const size_t entrySize = sizeof(TrajectoryRecorder::IndexEntry);
+    if (trailer.entryCount > size_t(end - begin - sizeof(trailer)) / entrySize)
+        throw std::runtime_error(filename_ + ": corrupt index");
+    const char *index = end - sizeof(trailer) - trailer.entryCount * entrySize;
+
+    // Chunks follow each other without gaps, so the entries alone locate
+    // them. Their headers are only checked when the chunks are read.
+    const char *chunk = begin;
+    for (size_t i = 0; i < trailer.entryCount; i++){
+        TrajectoryRecorder::IndexEntry entry;
+        std::memcpy(&entry, index + i * entrySize, entrySize);
+        if (entry.offset != uint64_t(chunk - file_.begin())
+                || size_t(index - chunk) < sizeof(TrajectoryRecorder::ChunkHeader))
+            throw std::runtime_error(filename_ + ": corrupt index");
+        chunk += sizeof(TrajectoryRecorder::ChunkHeader);
+        if (!isValidSize(entry.size, entry.sampleCount, index - chunk))
+            throw std::runtime_error(filename_ + ": corrupt index");
+
+        Chunk located = {chunk, entry.size, getSampleCount(), entry.sampleCount, entry.firstTime, entry.lastTime};
+        chunks_.push_back(located);
+        chunk += entry.size;
+    }
+    if (chunk != index)
+        throw std::runtime_error(filename_ + ": corrupt index");
+    return true;
+}
+
+/**
+ *  Locates the chunks from begin to end by following their headers, up to
+ *  the first incomplete chunk or a partly written index.
+ */
+void TrajectoryReader::scanChunks(const char *begin, const char *end){
+    while (begin != end){
+        // A recording that was cut short, e.g. by a crash, ends in a chunk
+        // or an index that was only partly written. The complete chunks
+        // before it are still readable.
+        if (isPartialIndex(begin, end))
+            return;
+        TrajectoryRecorder::ChunkHeader header;
+        if (size_t(end - begin) < sizeof(header))
+            return;
+        std::memcpy(&header, begin, sizeof(header));
+        if (std::memcmp(header.magic, "CHNK", sizeof(header.magic)) == 0
+                && header.size > size_t(end - begin) - sizeof(header))
+            return;
+
+        begin = addChunk(begin, end);
+        Chunk &chunk = chunks_.back();
+        readStream(chunk, 1, 0, 1, &chunk.firstTime, 1);
+        readStream(chunk, 1, chunk.sampleCount - 1, 1, &chunk.lastTime, 1);
+    }
+}
+
+/**
+ *  Returns true if the bytes from begin to end, which follow the chunks
+ *  located so far, can be the start of their index.
+ */
+bool TrajectoryReader::isPartialIndex(const char *begin, const char *end) const{
+    if (chunks_.empty() || std::memcmp(begin, "CHNK", std::min<size_t>(end - begin, 4)) == 0)
+        return false;
+    const size_t indexSize = chunks_.size() * sizeof(TrajectoryRecorder::IndexEntry)
+                             + sizeof(TrajectoryRecorder::IndexTrailer);
+    if (size_t(end - begin) > indexSize)
+        return false;
+
+    // The first entry locates the first chunk, of which as much as was
+    // written must match.
+    const uint64_t first = chunks_.front().payload - sizeof(TrajectoryRecorder::ChunkHeader) - file_.begin();
+    return std::memcmp(begin, &first, std::min<size_t>(end - begin, sizeof(first))) == 0;
+}
+
+/**
+ *  Checks the chunk header at chunk and appends the chunk.
+ */
+const char * TrajectoryReader::addChunk(const char *chunk, const char *end){
+    TrajectoryRecorder::ChunkHeader header;
+    if (size_t(end - chunk) < sizeof(header))
+        throw std::runtime_error(filename_ + ": truncated trajectory");
+    std::memcpy(&header, chunk, sizeof(header));
+    chunk += sizeof(header);
+    if (!isValidSize(header.size, header.sampleCount, end - chunk))
+        throw std::runtime_error(filename_ + ": truncated trajectory");
+
+    Chunk located = {chunk, header.size, getSampleCount(), header.sampleCount, 0.0, 0.0};
+    chunks_.push_back(located);
+    checkChunk(chunks_.back());
+    return chunk + header.size;
+}
+
+/**
+ *  Returns true if a payload of size bytes can hold sampleCount samples and
+ *  fits in available bytes.
+ */
+bool TrajectoryReader::isValidSize(uint64_t size, uint64_t sampleCount, size_t available){
+    return size <= available && size % 8 == 0 && sampleCount != 0 && sampleCount <= size;
+}
+
+/**
+ *  Checks that the header of chunk matches its location and returns the
+ *  encoding of its payload.
+ */
+uint32_t TrajectoryReader::checkChunk(const Chunk &chunk) const{
+    TrajectoryRecorder::ChunkHeader header;
+    std::memcpy(&header, chunk.payload - sizeof(header), sizeof(header));
+    if (std::memcmp(header.magic, "CHNK", sizeof(header.magic)) != 0 || header.size != chunk.size
+            || header.sampleCount != chunk.sampleCount)
+        throw std::runtime_error(filename_ + ": corrupt chunk");
+    if (header.encoding != TrajectoryRecorder::raw && header.encoding != TrajectoryRecorder::predictive)
+        throw std::runtime_error(filename_ + ": unknown chunk encoding " + std::to_string(header.encoding));
+
+    const uint64_t columns = 2 + TrajectoryRecorder::quantities * bodyCount_;
+    if (header.encoding == TrajectoryRecorder::raw && header.size != columns * header.sampleCount * sizeof(double))
+        throw std::runtime_error(filename_ + ": corrupt chunk");
+    return header.encoding;
+}
+
+/**
+ *  Returns the chunk that holds sample.
+ */
+const TrajectoryReader::Chunk & TrajectoryReader::findChunk(size_t sample) const{
+    if (sample >= getSampleCount())
+        throw std::invalid_argument(filename_ + " has no sample " + std::to_string(sample));
+    return *(std::upper_bound(chunks_.begin(), chunks_.end(), sample,
+                              [](size_t s, const Chunk &c) { return s < c.firstSample; }) - 1);
+}
+
+/**
+ *  Copies count values of stream of chunk, starting at its sample first, to
+ *  values with the given stride.
+ */
+template <typename T>
+void TrajectoryReader::readStream(const Chunk &chunk, size_t stream, size_t first, size_t count, T *values,
+                                  size_t stride) const{
+    const size_t n = chunk.sampleCount;
+    const char *source;
+    std::vector<T> decoded;
+    if (checkChunk(chunk) == TrajectoryRecorder::raw){
+        source = chunk.payload + (stream * n + first) * sizeof(T);
+    } else {
+        // Compressed columns can only be decoded from their start.
+        decoded.resize(n);
+        try {
+            TrajectoryCodec::decodeStream(chunk.payload, chunk.size, n, TrajectoryRecorder::quantities * bodyCount_,
+                                          stream, decoded.data());
+        } catch (const std::runtime_error &e){
+            throw std::runtime_error(filename_ + ": " + e.what());
+        }
+        source = reinterpret_cast<const char *>(decoded.data() + first);
+    }
+
+    if (stride == 1){
+        std::memcpy(values, source, count * sizeof(T));
+    } else {
+        for (size_t i = 0; i < count; i++)
+            std::memcpy(values + i * stride, source + i * sizeof(T), sizeof(T));
+    }
+}
+
+#endif
@@ -0,0 +1,356 @@
+/**
+ * @class TrajectoryRecorder.cpp
+ * @brief Streaming binary trajectory recorder
+ * @details Samples a Universe into a ring buffer on the simulation thread and
+ * writes the samples as columnar chunks on a background thread
+ *
+ * I affirm that this work is my own
+ * 2016-11-30
+ * @author Edward Goode
+ * VuID: goodees
+ * Email: edward.s.goode@vanderbilt.edu
+ */
+
+#ifndef _TRAJECTORY_RECORDER_CPP_
+#define _TRAJECTORY_RECORDER_CPP_
+
+#include "../include/TrajectoryRecorder.h"
+#include "../include/BinaryFormat.h"
+#include "../include/Object.h"
+#include "../include/TrajectoryCodec.h"
+#include "../include/Universe.h"
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+
+const uint32_t TrajectoryRecorder::version;
+const size_t TrajectoryRecorder::quantities;
+
+/**
+ *  Creates filename and attaches to universe.
+ */
+TrajectoryRecorder::TrajectoryRecorder(Universe &universe, const char *filename, size_t interval,
+                                       size_t bufferedSamples, size_t chunkBytes, Encoding encoding)
+        : universe_(&universe), filename_(filename), file_(std::fopen(filename, "wb"), &std::fclose),
+          interval_(std::max<size_t>(interval, 1)), bodyCount_(0), chunkSamples_(0),
+          chunkBytes_(chunkBytes), encoding_(encoding), samples_(0),
+          ring_(std::max<size_t>(bufferedSamples, 1)), head_(0), count_(0), written_(0),
+          stopping_(false){
+    if (!file_)
+        throw std::runtime_error("Unable to open " + filename_);
+
+    thread_ = std::thread(&TrajectoryRecorder::work, this);
+    universe.addObserver(this);
+}
+
+/**
+ *  Closes the recorder. Errors are ignored.
+ */
+TrajectoryRecorder::~TrajectoryRecorder(){
+    try {
+        close();
+    } catch (...) {
+    }
+}
+
+/**
+ *  Records a sample if the step count of universe is a multiple of the
+ *  interval.
+ */
+void TrajectoryRecorder::stepped(const Universe &universe){
+    if (universe.getStepCount() % interval_ == 0)
+        record(universe);
+}
+
+/**
+ *  Records a sample of universe now.
+ */
+void TrajectoryRecorder::record(const Universe &universe){
+    if (samples_ == 0){
+        writeHeader(universe);
+    } else if (size_t(std::distance(universe.begin(), universe.end())) != bodyCount_){
+        throw std::invalid_argument("The number of bodies changed while recording " + filename_);
+    }
+
+    size_t slot;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        changed_.wait(lock, [this]() { return count_ < ring_.size() || error_; });
+        rethrowError();
+        slot = head_;
+    }
+
+    // The slot is neither waiting nor being appended, so it is filled
+    // without holding the lock.
+    Sample &sample = ring_[slot];
+    sample.step = universe.getStepCount();
+    sample.time = universe.getTime();
+    double *x = sample.values.data();
+    double *y = x + bodyCount_;
+    double *vx = y + bodyCount_;
+    double *vy = vx + bodyCount_;
+    for (Universe::const_iterator i = universe.begin(); i != universe.end(); ++i){
+        const vector2 position = (*i)->getPosition();
+        const vector2 velocity = (*i)->getVelocity();
+        *x++ = position[0];
+        *y++ = position[1];
+        *vx++ = velocity[0];
+        *vy++ = velocity[1];
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        head_ = (head_ + 1) % ring_.size();
+        count_++;
+    }
+    changed_.notify_all();
+    samples_++;
+}
+
+/**
+ *  Detaches from the Universe, writes every buffered sample, and closes the
+ *  file.
+ */
+void TrajectoryRecorder::close(){
+    if (!thread_.joinable())
+        return;
+
+    std::exception_ptr headerError;
+    if (universe_){
+        Universe &universe = *universe_;
+        universe_ = nullptr;
+        universe.removeObserver(this);
+        // An empty recording still names its bodies.
+        try {
+            if (samples_ == 0)
+                writeHeader(universe);
+        } catch (...) {
+            headerError = std::current_exception();
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    changed_.notify_all();
+    thread_.join();
+
+    const bool closed = std::fclose(file_.release()) == 0;
+    if (headerError)
+        std::rethrow_exception(headerError);
+    rethrowError();
+    if (!closed)
+        throw std::runtime_error("Unable to write " + filename_);
+}
+
+/**
+ *  Returns the number of samples recorded so far.
+ */
+size_t TrajectoryRecorder::getSampleCount() const{
+    return samples_;
+}
+
+/**
+ *  Returns a file header with the magic, byte order mark and version filled
+ *  in.
+ */
+TrajectoryRecorder::FileHeader TrajectoryRecorder::makeFileHeader(){
+    FileHeader header = FileHeader();
+    std::memcpy(header.magic, "NBTRAJ", sizeof("NBTRAJ"));
+    header.byteOrder = BinaryFormat::byteOrderMark;
+    header.version = version;
+    return header;
+}
+
+/**
+ *  Returns an index trailer with the magic filled in.
+ */
+TrajectoryRecorder::IndexTrailer TrajectoryRecorder::makeIndexTrailer(){
+    IndexTrailer trailer = IndexTrailer();
+    std::memcpy(trailer.magic, "NBTRIDX", sizeof("NBTRIDX"));
+    return trailer;
+}
+
+/**
+ *  Returns the number of zero bytes that align size bytes to 8.
+ */
+size_t TrajectoryRecorder::padding(size_t size){
+    return BinaryFormat::padding(size);
+}
+
+/**
+ *  Body of the writer thread.
+ */
+void TrajectoryRecorder::work(){
+    std::unique_lock<std::mutex> lock(mutex_);
+    // After an error the samples are only drained so that the simulation
+    // does not block; the next record() reports the error.
+    bool failed = false;
+
+    while (true){
+        changed_.wait(lock, [this]() { return stopping_ || count_ > 0; });
+        if (count_ == 0)
+            break;
+
+        const size_t slot = (head_ + ring_.size() - count_) % ring_.size();
+        lock.unlock();
+
+        try {
+            if (!failed)
+                append(ring_[slot]);
+        } catch (...) {
+            failed = true;
+            lock.lock();
+            error_ = std::current_exception();
+            lock.unlock();
+        }
+
+        lock.lock();
+        count_--;
+        changed_.notify_all();
+    }
+    lock.unlock();
+
+    try {
+        if (!failed && !chunkSteps_.empty())
+            writeChunk();
+        if (!failed)
+            writeIndex();
+    } catch (...) {
+        lock.lock();
+        error_ = std::current_exception();
+    }
+}
+
+/**
+ *  Appends sample to the chunk being assembled.
+ */
+void TrajectoryRecorder::append(const Sample &sample){
+    const size_t index = chunkSteps_.size();
+    chunkSteps_.push_back(sample.step);
+    chunkTimes_.push_back(sample.time);
+
+    const size_t columns = quantities * bodyCount_;
+    const double *values = sample.values.data();
+    double *column = chunkColumns_.data() + index;
+    for (size_t k = 0; k < columns; k++)
+        column[k * chunkSamples_] = values[k];
+
+    if (chunkSteps_.size() == chunkSamples_)
+        writeChunk();
+}
+
+/**
+ *  Writes the file header and the names of universe. Also sizes the ring
+ *  buffer and the chunk for the number of bodies.
+ */
+void TrajectoryRecorder::writeHeader(const Universe &universe){
+    std::vector<uint64_t> offsets(1, 0);
+    std::string names;
+    for (Universe::const_iterator i = universe.begin(); i != universe.end(); ++i){
+        names += (*i)->getName();
+        offsets.push_back(names.size());
+    }
+    bodyCount_ = offsets.size() - 1;
+
+    FileHeader header = makeFileHeader();
+    header.bodyCount = bodyCount_;
+    header.namesSize = names.size();
+    header.interval = interval_;
+    names.resize(names.size() + padding(names.size()), '\0');
+
+    write(&header, sizeof(header));
+    write(offsets.data(), offsets.size() * sizeof(uint64_t));
+    write(names.data(), names.size());
+
+    // Chunks hold at least one sample however many bodies there are.
+    const size_t sampleBytes = (quantities * bodyCount_ + 2) * sizeof(double);
+    chunkSamples_ = std::max<size_t>(chunkBytes_ / sampleBytes, 1);
+    chunkSteps_.reserve(chunkSamples_);
+    chunkTimes_.reserve(chunkSamples_);
+    chunkColumns_.resize(quantities * bodyCount_ * chunkSamples_);
+    for (Sample &sample : ring_)
+        sample.values.resize(quantities * bodyCount_);
+}
+
+/**
+ *  Writes the assembled chunk and starts a new one.
+ */
+void TrajectoryRecorder::writeChunk(){
+    const size_t count = chunkSteps_.size();
+    const size_t columns = quantities * bodyCount_;
+
+    // A partial chunk is compacted so that its columns are contiguous.
+    if (count < chunkSamples_)
+        for (size_t k = 1; k < columns; k++)
+            std::memmove(&chunkColumns_[k * count], &chunkColumns_[k * chunkSamples_],
+                         count * sizeof(double));
+
+    ChunkHeader header = ChunkHeader();
+    std::memcpy(header.magic, "CHNK", sizeof(header.magic));
+    header.encoding = encoding_;
+    header.sampleCount = count;
+    if (encoding_ == predictive){
+        TrajectoryCodec::encodeChunk(count, columns, chunkSteps_.data(), chunkTimes_.data(),
+                                     chunkColumns_.data(), payload_);
+        header.size = payload_.size();
+    } else {
+        header.size = (2 + columns) * count * sizeof(double);
+    }
+
+    IndexEntry entry;
+    entry.offset = written_;
+    entry.sampleCount = count;
+    entry.size = header.size;
+    entry.firstStep = chunkSteps_.front();
+    entry.lastStep = chunkSteps_.back();
+    entry.firstTime = chunkTimes_.front();
+    entry.lastTime = chunkTimes_.back();
+    index_.push_back(entry);
+
+    write(&header, sizeof(header));
+    if (encoding_ == predictive){
+        write(payload_.data(), payload_.size());
+    } else {
+        write(chunkSteps_.data(), count * sizeof(uint64_t));
+        write(chunkTimes_.data(), count * sizeof(double));
+        write(chunkColumns_.data(), columns * count * sizeof(double));
+    }
+
+    chunkSteps_.clear();
+    chunkTimes_.clear();
+}
+
+/**
+ *  Writes the index of the chunks written so far.
+ */
+void TrajectoryRecorder::writeIndex(){
+    IndexTrailer trailer = makeIndexTrailer();
+    trailer.entryCount = index_.size();
+    write(index_.data(), index_.size() * sizeof(IndexEntry));
+    write(&trailer, sizeof(trailer));
+}
+
+/**
+ *  Writes size bytes of data.
+ */
+void TrajectoryRecorder::write(const void *data, size_t size){
+    if (size != 0 && std::fwrite(data, 1, size, file_.get()) != size)
+        throw std::runtime_error("Unable to write " + filename_);
+    written_ += size;
+}
+
+/**
+ *  Rethrows and clears the first error of the writer thread, if any.
+ */
+void TrajectoryRecorder::rethrowError(){
+    if (error_){
+        std::exception_ptr error = error_;
+        error_ = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+#endif
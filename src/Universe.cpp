@@ -1,6 +1,6 @@
 /**
  * @class Universe.cpp
- * @brief A singleton universe to simulate planetary ineraction
+ * @brief A universe to simulate planetary ineraction
  * @details Holds a vector with objects
  *
  * I affirm that this work is my own
@@ -15,12 +15,17 @@
 
 #include "../include/Universe.h"
 #include "../include/Object.h"
+#include "../include/UniverseObserver.h"
+#include <algorithm>
+#include <atomic>
 #include <cmath>
 
 Universe *Universe::instance_ = nullptr;
+const size_t Universe::stateSlots;
+const unsigned Universe::writing;
 
 /**
- *  Returns the only instance of the Universe
+ *  Returns the default instance of the Universe, creating it on first use.
  */
 Universe* Universe::instance(){
     if (instance_ == nullptr)
@@ -35,24 +40,27 @@ Universe* Universe::instance(){
  *  experienced by obj2.
  */
 vector2 Universe::getForce(const Object &obj1, const Object &obj2){
-    double numerator = G * obj1.getMass() * obj2.getMass();
-    double denominator = (obj1.getPosition() - obj2.getPosition()).normSq();
-    double operation = numerator/denominator;
-    vector2 direction = (obj1.getPosition() - obj2.getPosition()).normalize();
-    vector2 zero;
-
     if(obj2.getName() == obj1.getName())
-        return zero;
+        return vector2();
+
+    double numerator = G * obj1.getMass() * obj2.getMass();
+    vector2 displacement = obj1.getPosition() - obj2.getPosition();
 
-    return operation * direction;
+    // One square root and no divisions: the displacement over its cubed norm
+    // is the direction over the squared distance.
+    return numerator * displacement.inverseSquare(NormPrecision::exact);
 }
 
 /**
- *  Releases all the dynamic objects still registered with the Universe.
+ *  Releases all the dynamic objects still registered with the Universe. If
+ *  this is the default instance, the next call to instance() creates a new
+ *  one.
  */
 Universe::~Universe(){
     release(objects_);
-    instance_ = nullptr;
+
+    if (instance_ == this)
+        instance_ = nullptr;
 }
 
 /**
@@ -63,6 +71,18 @@ void Universe::addObject(Object *ptr){
     objects_.push_back(ptr);
 }
 
+/**
+ *  Registers all Objects in the container with the universe, in order, and
+ *  clears the container.
+ */
+void Universe::addObjects(std::vector<Object*> &objects){
+    if (objects_.empty())
+        objects_.swap(objects);
+    else
+        objects_.insert(objects_.end(), objects.begin(), objects.end());
+    objects.clear();
+}
+
 /**
  *  Returns the begin iterator to the actual Objects. The order of itetarion
  *  will be the same as that over getSnapshot()'s result as long as no new
@@ -124,20 +144,33 @@ void Universe::stepSimulation(const double &timeSec){
     for(size_t i = 1; i < objects_.size(); i++){
         vector2 forceOnObj;
 
-        for(Object *obj: objects_)
-            forceOnObj += getForce(*obj, *newVector[i]);
+        if(summation_ == Summation::compensated){
+            CompensatedSum<vector2> sum;
+            for(Object *obj: objects_)
+                sum += getForce(*obj, *newVector[i]);
+            forceOnObj = sum.sum();
+        } else {
+            for(Object *obj: objects_)
+                forceOnObj += getForce(*obj, *newVector[i]);
+        }
 
         vector2 acceleration = forceOnObj / (*newVector[i]).getMass();
-        vector2 deltaVelocity = acceleration * timeSec;
-        vector2 velocity = (*newVector[i]).getVelocity() + deltaVelocity;
-        vector2 deltaPosition = velocity * timeSec;
-        vector2 position = (*newVector[i]).getPosition() + deltaPosition;
+        vector2 velocity = (*newVector[i]).getVelocity().addScaled(acceleration, timeSec);
+        vector2 position = (*newVector[i]).getPosition().addScaled(velocity, timeSec);
         (*newVector[i]).setPosition(position);
         (*newVector[i]).setVelocity(velocity);
 
     }
 
     swap(newVector);
+    time_ += timeSec;
+    steps_++;
+
+    if(publishInterval_ != 0 && steps_ % publishInterval_ == 0)
+        publishState();
+
+    for(UniverseObserver *observer: observers_)
+        observer->stepped(*this);
 }
 
 /**
@@ -159,7 +192,113 @@ void Universe::release(std::vector<Object*> &objects){
     objects.clear();
 }
 
-Universe::Universe(){
+/**
+ *  Returns the number of times stepSimulation has been called.
+ */
+size_t Universe::getStepCount() const{
+    return steps_;
+}
+
+/**
+ *  Returns the simulated time in seconds, i.e. the sum of all time steps
+ *  taken so far.
+ */
+double Universe::getTime() const{
+    return time_;
+}
+
+/**
+ *  Publishes a new UniverseState after every interval steps. An interval
+ *  of zero (the default) disables automatic publishing.
+ */
+void Universe::setPublishInterval(size_t interval){
+    publishInterval_ = interval;
+}
+
+/**
+ *  Selects how the forces on each body are summed.
+ */
+void Universe::setSummation(Summation summation){
+    summation_ = summation;
+}
+
+/**
+ *  Returns how the forces on each body are summed.
+ */
+Summation Universe::getSummation() const{
+    return summation_;
+}
+
+/**
+ *  Captures the current bodies into an immutable UniverseState and makes it
+ *  the version returned by getState(). Only the simulation thread may call
+ *  this method.
+ */
+void Universe::publishState(){
+    std::shared_ptr<const UniverseState> state =
+            std::make_shared<const UniverseState>(objects_, steps_, time_);
+
+    // Claim a slot no reader is copying from. Readers only hold a pin for the
+    // duration of a pointer copy, so some slot other than the current one is
+    // free almost immediately.
+    const size_t current = current_.load(std::memory_order_relaxed);
+    size_t next = current;
+    unsigned unpinned;
+    do {
+        next = (next + 1) % stateSlots;
+        unpinned = 0;
+    } while (next == current || !states_[next].pins.compare_exchange_weak(unpinned, writing,
+                                                                          std::memory_order_acquire,
+                                                                          std::memory_order_relaxed));
+
+    // The version held by the slot is released here, or by the last reader
+    // still holding it, whichever comes later.
+    states_[next].state.swap(state);
+    states_[next].pins.fetch_sub(writing, std::memory_order_release);
+    current_.store(next, std::memory_order_release);
+}
+
+/**
+ *  Returns the most recently published state, or nullptr if nothing has
+ *  been published yet. Safe to call from any thread while the simulation
+ *  steps.
+ */
+std::shared_ptr<const UniverseState> Universe::getState() const{
+    for (;;){
+        const StateSlot &slot = states_[current_.load(std::memory_order_acquire)];
+        // A slot that is being replaced is no longer current, so look again.
+        if ((slot.pins.fetch_add(1, std::memory_order_acquire) & writing) == 0){
+            std::shared_ptr<const UniverseState> state = slot.state;
+            slot.pins.fetch_sub(1, std::memory_order_release);
+            return state;
+        }
+        slot.pins.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+/**
+ *  Registers observer to be notified after every step.
+ */
+void Universe::addObserver(UniverseObserver *observer){
+    observers_.push_back(observer);
+}
+
+/**
+ *  Stops notifying observer.
+ */
+void Universe::removeObserver(UniverseObserver *observer){
+    observers_.erase(std::remove(observers_.begin(), observers_.end(), observer), observers_.end());
+}
+
+UniverseObserver::~UniverseObserver() {}
+
+/**
+ *  Creates an empty Universe that is independent of instance().
+ */
+Universe::Universe() : steps_(0), time_(0.0), publishInterval_(0),
+        summation_(Summation::naive), current_(0){
+    for (StateSlot &slot : states_)
+        slot.pins.store(0, std::memory_order_relaxed);
 }
 
 #endif
\ No newline at end of file
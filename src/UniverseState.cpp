@@ -0,0 +1,44 @@
+/**
+ * @class UniverseState.cpp
+ * @brief A read-only copy of the Universe published for observer threads
+ * @details Stores the bodies column by column so readers can scan them quickly
+ *
+ * I affirm that this work is my own
+ * 2016-11-30
+ * @author Edward Goode
+ * VuID: goodees
+ * Email: edward.s.goode@vanderbilt.edu
+ */
+
+#ifndef _UNIVERSE_STATE_CPP_
+#define _UNIVERSE_STATE_CPP_
+
+#include "../include/UniverseState.h"
+#include "../include/Object.h"
+
+/**
+ *  Copies the properties of the provided objects.
+ */
+UniverseState::UniverseState(const std::vector<Object*> &objects, size_t step, double time) :
+        step(step), time(time) {
+    names.reserve(objects.size());
+    masses.reserve(objects.size());
+    positions.reserve(objects.size());
+    velocities.reserve(objects.size());
+
+    for (const Object *obj : objects){
+        names.push_back(obj->getName());
+        masses.push_back(obj->getMass());
+        positions.push_back(obj->getPosition());
+        velocities.push_back(obj->getVelocity());
+    }
+}
+
+/**
+ *  Returns the number of bodies captured in this state.
+ */
+size_t UniverseState::size() const{
+    return names.size();
+}
+
+#endif
@@ -2,11 +2,9 @@
 #define _VECTOR_CPP_
 
 #include "../include/Vector.h"
-#include "../include/VectorHelpers.h"
+#include "../include/VectorKernels.h"
 
 #include <algorithm>
-#include <iterator>
-#include <sstream>
 #include <cmath>
 #include <stdexcept>
 #include <functional>
@@ -14,17 +12,51 @@
 /**
  *  Creates the zero vector.
  */
-template <size_t DIM>
-Vector<DIM>::Vector() {
-    std::fill(begin(), end(), 0.0);
+template <size_t DIM, typename T>
+constexpr Vector<DIM, T>::Vector() : data_() {
 }
 
 /**
  *  Creates a vector using the first DIM values starting at ptr.
  */
-template <size_t DIM>
-Vector<DIM>::Vector(const double *ptr) {
-    std::copy(ptr, ptr + DIM, begin());
+template <size_t DIM, typename T>
+constexpr Vector<DIM, T>::Vector(const T *ptr) : data_() {
+    for (size_t i = 0; i < DIM; ++i)
+        data_[i] = ptr[i];
+}
+
+/**
+ *  Creates a vector by evaluating expr.
+ */
+template <size_t DIM, typename T>
+template <typename E>
+constexpr Vector<DIM, T>::Vector(const VectorExpression<DIM, T, E> &expr) : data_() {
+    for (size_t i = 0; i < DIM; ++i)
+        data_[i] = expr.self()[i];
+}
+
+/**
+ *  Creates a vector by evaluating expr and converting each component from
+ *  U to T.
+ */
+template <size_t DIM, typename T>
+template <typename U, typename E>
+constexpr Vector<DIM, T>::Vector(const VectorExpression<DIM, U, E> &expr) : data_() {
+    for (size_t i = 0; i < DIM; ++i)
+        data_[i] = static_cast<T>(expr.self()[i]);
+}
+
+/**
+ *  Evaluates expr into this vector and returns the result for chaining.
+ */
+template <size_t DIM, typename T>
+template <typename E>
+constexpr Vector<DIM, T> & Vector<DIM, T>::operator=(const VectorExpression<DIM, T, E> &expr) {
+    // Every component of an expression only depends on the same component of
+    // its operands, so evaluating in place is safe even if expr refers to us.
+    for (size_t i = 0; i < DIM; ++i)
+        data_[i] = expr.self()[i];
+    return *this;
 }
 
 /*******************************************************************************
@@ -36,263 +68,369 @@ Vector<DIM>::Vector(const double *ptr) {
 /**
  *  Returns the sum of this vector and rhs.
  */
-template <size_t DIM>
-const Vector<DIM> Vector<DIM>::add(const Vector<DIM> &rhs) const {
-    Vector<DIM> sum;
-    std::transform(begin(), end(), rhs.begin(), sum.begin(), adder());
+template <size_t DIM, typename T>
+constexpr const Vector<DIM, T> Vector<DIM, T>::add(const Vector<DIM, T> &rhs) const {
+    if (VECTOR_CONSTANT_EVALUATED())
+        return *this + rhs;
+    Vector<DIM, T> sum;
+    VectorKernels<DIM, T>::add(data_, rhs.data_, sum.data_);
     return sum;
 }
 
 /**
  *  Returns the additive inverse of this vector.
  */
-template <size_t DIM>
-const Vector<DIM> Vector<DIM>::invert() const {
-    return scale(-1.0);
+template <size_t DIM, typename T>
+constexpr const Vector<DIM, T> Vector<DIM, T>::invert() const {
+    return scale(T(-1));
 }
 
 /**
  *  Scales a copy of this vector by rhs and returns the result.
  */
-template <size_t DIM>
-const Vector<DIM> Vector<DIM>::scale(const double &rhs) const{
-    Vector<DIM> s;
-    // Via a binder, we can reuse multiplier with a transform
-    std::transform(begin(), end(), s.begin(), std::bind2nd(multiplier(), rhs));
+template <size_t DIM, typename T>
+constexpr const Vector<DIM, T> Vector<DIM, T>::scale(const T &rhs) const{
+    if (VECTOR_CONSTANT_EVALUATED())
+        return *this * rhs;
+    Vector<DIM, T> s;
+    VectorKernels<DIM, T>::scale(data_, rhs, s.data_);
     return s;
 }
 
 /**
- *  Returns the dot (inner) product of this vector and rhs.
+ *  Returns this vector plus x scaled by a, computed in one pass with fused
+ *  multiply-adds where the hardware allows it.
  */
-template <size_t DIM>
-double Vector<DIM>::dot(const Vector<DIM> &rhs) const {
-    // transform will return the output iterator. Therefore, I hacked together
-    // an iterator that will actually accumulate the values that are "assigned
-    // to its content."
-    return std::transform(begin(), end(), rhs.begin(), accumulator_iter(),
-                          multiplier()).accumulator;
+template <size_t DIM, typename T>
+constexpr const Vector<DIM, T> Vector<DIM, T>::addScaled(const Vector<DIM, T> &x, const T &a) const {
+    if (VECTOR_CONSTANT_EVALUATED())
+        return *this + x * a;
+    Vector<DIM, T> sum;
+    VectorKernels<DIM, T>::axpy(a, x.data_, data_, sum.data_);
+    return sum;
 }
 
 /**
- *  Returns the square of the magnitude of this vector.
+ *  Increments this vector by x scaled by a (the BLAS axpy) in place and
+ *  returns the result for chaining. Fused where the hardware allows it.
  */
-template <size_t DIM>
-double Vector<DIM>::normSq() const {
-    // Dot product of a vector with itself yields the square of the norm.
-    return dot(*this);
+template <size_t DIM, typename T>
+constexpr Vector<DIM, T> & Vector<DIM, T>::axpy(const T &a, const Vector<DIM, T> &x) {
+    if (VECTOR_CONSTANT_EVALUATED()) {
+        for (size_t i = 0; i < DIM; ++i)
+            data_[i] += a * x.data_[i];
+    } else {
+        VectorKernels<DIM, T>::axpy(a, x.data_, data_, data_);
+    }
+    return *this;
 }
 
 /**
- *  Returns the magnitude of this vector.
+ *  Returns the dot (inner) product of this vector and rhs. The products are
+ *  accumulated with fused multiply-adds where the hardware allows it.
  */
-template <size_t DIM>
-double Vector<DIM>::norm() const {
-    return std::sqrt(normSq());
+template <size_t DIM, typename T>
+constexpr T Vector<DIM, T>::dot(const Vector<DIM, T> &rhs) const {
+    if (VECTOR_CONSTANT_EVALUATED())
+        return VectorExpression<DIM, T, Vector<DIM, T> >::dot(rhs);
+    return VectorKernels<DIM, T>::dot(data_, rhs.data_);
 }
 
 /**
- *  Scales this vector such that its magnitude is 1 and returns the result
- *  for chaining.
+ *  Returns the dot (inner) product of this vector and rhs, accumulating the
+ *  products as selected by summation.
  */
-template <size_t DIM>
-Vector<DIM> & Vector<DIM>::normalize() {
-    return *this /= norm();
+template <size_t DIM, typename T>
+T Vector<DIM, T>::dot(const Vector<DIM, T> &rhs, Summation summation) const {
+    if (summation == Summation::naive)
+        return dot(rhs);
+    return std::transform(begin(), end(), rhs.begin(), accumulator_iter<T, CompensatedSum<T> >(),
+                          multiplier<T>()).accumulator.sum();
 }
 
 /**
- *  Returns the cross product of this and rhs if called on a 3D vector.
- *  throws an std::domain_error otherwise.
+ *  Returns the square of the magnitude of this vector.
  */
-template <size_t DIM>
-const Vector<DIM> Vector<DIM>::cross(const Vector<DIM> &v) const {
-    (void)(v);
-    throw std::domain_error("Operation not supported");
+template <size_t DIM, typename T>
+constexpr T Vector<DIM, T>::normSq() const {
+    // Dot product of a vector with itself yields the square of the norm.
+    return dot(*this);
 }
 
-template <>
-inline const Vector<3> Vector<3>::cross(const Vector<3> &v) const {
-    Vector<3> c;
-    c[0] = (*this)[1] * v[2] - (*this)[2] * v[1];
-    c[1] = (*this)[2] * v[0] - (*this)[0] * v[2];
-    c[2] = (*this)[0] * v[1] - (*this)[1] * v[0];
-    return c;
+/**
+ *  Returns the magnitude of this vector.
+ */
+template <size_t DIM, typename T>
+T Vector<DIM, T>::norm() const {
+    return std::sqrt(normSq());
 }
 
 /**
- *  Returns a human readable representation of this vector.
- *  Ex. [1 2 3]
+ *  Returns 1 / norm(), computed as selected by precision (see NormPrecision).
  */
-template <size_t DIM>
-std::string Vector<DIM>::toString() const {
-    std::stringstream str;
-    str << "[";
-    // We know that DIM is at least 1 so the following is safe and lets us
-    // avoid substringing to erase the final space that the naive approach would
-    // produce.
-    std::copy(begin(), end() - 1, std::ostream_iterator<double>(str, " "));
-    str << (*this)[DIM - 1] << "]";
-    return str.str();
+template <size_t DIM, typename T>
+T Vector<DIM, T>::inverseNorm(NormPrecision precision) const {
+    return inverseSqrt(normSq(), precision);
 }
 
-/***************************************************************************
-*                                                                          *
-*                  O V E R L O A D E D   O P E R A T O R S                 *
-*                                                                          *
-***************************************************************************/
-
 /**
- *  Returns true if this vector equals rhs.
+ *  Returns a copy of this vector scaled by inverseNorm(precision), i.e. of
+ *  magnitude 1.
  */
-template <size_t DIM>
-bool Vector<DIM>::operator==(const Vector<DIM> &rhs) const {
-    return std::equal(begin(), end(), rhs.begin());
+template <size_t DIM, typename T>
+const Vector<DIM, T> Vector<DIM, T>::direction(NormPrecision precision) const {
+    return scale(inverseNorm(precision));
 }
 
 /**
- *  Returns true if this vector differs from rhs.
+ *  Returns a copy of this vector divided by the cube of its magnitude. Takes a
+ *  single inverseNorm(precision) and no division.
  */
-template <size_t DIM>
-bool Vector<DIM>::operator!=(const Vector<DIM> &rhs) const {
-    return !(*this == rhs);
+template <size_t DIM, typename T>
+const Vector<DIM, T> Vector<DIM, T>::inverseSquare(NormPrecision precision) const {
+    T inverse = inverseNorm(precision);
+    return scale(inverse * inverse * inverse);
 }
 
 /**
- *  Returns a reference to the index-th component of this vector. Not range
- *  checked.
+ *  Scales this vector such that its magnitude is 1 and returns the result
+ *  for chaining.
  */
-template <size_t DIM>
-double & Vector<DIM>::operator[](size_t index) {
-    return data_[index];
+template <size_t DIM, typename T>
+Vector<DIM, T> & Vector<DIM, T>::normalize() {
+    VectorKernels<DIM, T>::normalize(data_);
+    return *this;
 }
 
 /**
- *  Returns a reference to the index-th component of this vector. Not range
- *  checked.
+ *  Computes cross products. Only 3D vectors have one, so the generic version
+ *  throws and the 3D version is a partial specialization; member functions of
+ *  Vector cannot be partially specialized on DIM alone. Only the 3D version is
+ *  constexpr, since the generic one can never be a constant expression.
  */
-template <size_t DIM>
-const double & Vector<DIM>::operator[](size_t index) const {
-    return data_[index];
+template <size_t DIM, typename T>
+struct CrossProduct {
+    static const Vector<DIM, T> apply(const Vector<DIM, T> &u, const Vector<DIM, T> &v) {
+        (void)(u);
+        (void)(v);
+        throw std::domain_error("Operation not supported");
+    }
+};
+
+template <typename T>
+struct CrossProduct<3, T> {
+    static constexpr const Vector<3, T> apply(const Vector<3, T> &u, const Vector<3, T> &v) {
+        Vector<3, T> c;
+        c[0] = u[1] * v[2] - u[2] * v[1];
+        c[1] = u[2] * v[0] - u[0] * v[2];
+        c[2] = u[0] * v[1] - u[1] * v[0];
+        return c;
+    }
+};
+
+/**
+ *  Returns the cross product of this and rhs if called on a 3D vector.
+ *  throws an std::domain_error otherwise.
+ */
+template <size_t DIM, typename T>
+constexpr const Vector<DIM, T> Vector<DIM, T>::cross(const Vector<DIM, T> &v) const {
+    return CrossProduct<DIM, T>::apply(*this, v);
 }
 
 /**
- *  Returns the sum of this vector and rhs.
+ *  Returns a human readable representation of this vector. Each component
+ *  is written with the fewest digits that read back as the same value.
+ *  Ex. [1 2.5 1.98892e+30]
  */
-template <size_t DIM>
-Vector<DIM> Vector<DIM>::operator+(const Vector<DIM> &rhs) const {
-    return add(rhs);
+template <size_t DIM, typename T>
+std::string Vector<DIM, T>::toString() const {
+    char buffer[maxStringLength];
+    return std::string(buffer, appendTo(buffer));
 }
 
 /**
- *  Increments this vector by rhs and returns the result for chaining.
+ *  Writes the text of toString() to buffer, which must have room for
+ *  maxStringLength characters, and returns a pointer one past the last
+ *  character written.
  */
-template <size_t DIM>
-Vector<DIM> & Vector<DIM>::operator+=(const Vector<DIM> &rhs) {
-    return *this = *this + rhs;
+template <size_t DIM, typename T>
+char * Vector<DIM, T>::appendTo(char *buffer) const {
+    *buffer++ = '[';
+    // We know that DIM is at least 1, so every component but the first is
+    // preceded by a space.
+    buffer = FastFormat::format(data_[0], buffer);
+    for (size_t i = 1; i < DIM; ++i) {
+        *buffer++ = ' ';
+        buffer = FastFormat::format(data_[i], buffer);
+    }
+    *buffer++ = ']';
+    return buffer;
 }
 
 /**
- *  Returns the additive inverse of this vector.
+ *  Appends the text of toString() to out. Allocates no memory unless out has
+ *  to grow.
  */
-template <size_t DIM>
-Vector<DIM> Vector<DIM>::operator-() const {
-    return scale(-1.0);
+template <size_t DIM, typename T>
+void Vector<DIM, T>::appendTo(std::string &out) const {
+    char buffer[maxStringLength];
+    out.append(buffer, appendTo(buffer));
 }
 
+/***************************************************************************
+*                                                                          *
+*                  O V E R L O A D E D   O P E R A T O R S                 *
+*                                                                          *
+***************************************************************************/
+
 /**
- *  Returns the difference between this vector and rhs.
+ *  Returns a reference to the index-th component of this vector. Not range
+ *  checked.
  */
-template <size_t DIM>
-Vector<DIM> Vector<DIM>::operator-(const Vector<DIM> &rhs) const {
-    return *this + -rhs;
+template <size_t DIM, typename T>
+constexpr T & Vector<DIM, T>::operator[](size_t index) {
+    return data_[index];
 }
 
 /**
- *  Decrements this vector by rhs and returns the result for chaining.
+ *  Returns a reference to the index-th component of this vector. Not range
+ *  checked.
  */
-template <size_t DIM>
-Vector<DIM> & Vector<DIM>::operator-=(const Vector<DIM> &v) {
-    return *this += -v;
+template <size_t DIM, typename T>
+constexpr const T & Vector<DIM, T>::operator[](size_t index) const {
+    return data_[index];
 }
 
 /**
- *  Scales this vector by rhs and returns the result for chaining.
+ *  Increments this vector by rhs and returns the result for chaining.
  */
-template <size_t DIM>
-Vector<DIM> & Vector<DIM>::operator*=(const double &rhs) {
-    return *this = scale(rhs);
+template <size_t DIM, typename T>
+constexpr Vector<DIM, T> & Vector<DIM, T>::operator+=(const Vector<DIM, T> &rhs) {
+    if (VECTOR_CONSTANT_EVALUATED()) {
+        for (size_t i = 0; i < DIM; ++i)
+            data_[i] += rhs.data_[i];
+    } else {
+        VectorKernels<DIM, T>::add(data_, rhs.data_, data_);
+    }
+    return *this;
 }
 
 /**
- *  Scales this vector by 1.0 / rhs and returns the result for chaining.
+ *  Increments this vector by rhs and returns the result for chaining.
  */
-template <size_t DIM>
-Vector<DIM>& Vector<DIM>::operator/=(const double& rhs) {
-    return *this *= (1.0 / rhs);
+template <size_t DIM, typename T>
+template <typename E>
+constexpr Vector<DIM, T> & Vector<DIM, T>::operator+=(const VectorExpression<DIM, T, E> &rhs) {
+    for (size_t i = 0; i < DIM; ++i)
+        data_[i] += rhs.self()[i];
+    return *this;
 }
 
 /**
- *  Scales a copy of this vector by rhs and returns the result.
+ *  Decrements this vector by rhs and returns the result for chaining.
  */
-template <size_t DIM>
-Vector<DIM> Vector<DIM>::operator*(const double &rhs) const {
-    return scale(rhs);
+template <size_t DIM, typename T>
+constexpr Vector<DIM, T> & Vector<DIM, T>::operator-=(const Vector<DIM, T> &v) {
+    if (VECTOR_CONSTANT_EVALUATED()) {
+        for (size_t i = 0; i < DIM; ++i)
+            data_[i] -= v.data_[i];
+    } else {
+        VectorKernels<DIM, T>::subtract(data_, v.data_, data_);
+    }
+    return *this;
 }
 
 /**
- *  Scales a copy of this vector by 1.0 / rhs and returns the result.
+ *  Decrements this vector by rhs and returns the result for chaining.
  */
-template <size_t DIM>
-Vector<DIM> Vector<DIM>::operator/(const double &rhs) const {
-    return scale(1.0 / rhs);
+template <size_t DIM, typename T>
+template <typename E>
+constexpr Vector<DIM, T> & Vector<DIM, T>::operator-=(const VectorExpression<DIM, T, E> &v) {
+    for (size_t i = 0; i < DIM; ++i)
+        data_[i] -= v.self()[i];
+    return *this;
 }
 
 /**
- *  Returns the dot (inner) product of this vector and rhs.
+ *  Scales this vector by rhs and returns the result for chaining.
  */
-template <size_t DIM>
-double Vector<DIM>::operator*(const Vector<DIM> &rhs) const {
-    return dot(rhs);
+template <size_t DIM, typename T>
+constexpr Vector<DIM, T> & Vector<DIM, T>::operator*=(const T &rhs) {
+    if (VECTOR_CONSTANT_EVALUATED()) {
+        for (size_t i = 0; i < DIM; ++i)
+            data_[i] *= rhs;
+    } else {
+        VectorKernels<DIM, T>::scale(data_, rhs, data_);
+    }
+    return *this;
 }
 
 /**
- *  Returns the cross product of this and rhs if called on a 3D vector.
- *  throws an std::domain_error otherwise.
+ *  Scales this vector by 1.0 / rhs and returns the result for chaining.
  */
-template <size_t DIM>
-Vector<DIM> Vector<DIM>::operator^(const Vector<DIM> &v) const {
-    return cross(v);
+template <size_t DIM, typename T>
+constexpr Vector<DIM, T>& Vector<DIM, T>::operator/=(const T& rhs) {
+    return *this *= (T(1) / rhs);
 }
 
-template <size_t DIM>
-double* Vector<DIM>::begin() {
+template <size_t DIM, typename T>
+T* Vector<DIM, T>::begin() {
     return data_;
 }
 
-template <size_t DIM>
-const double* Vector<DIM>::begin() const {
+template <size_t DIM, typename T>
+const T* Vector<DIM, T>::begin() const {
     return data_;
 }
 
-template <size_t DIM>
-double* Vector<DIM>::end() {
+template <size_t DIM, typename T>
+T* Vector<DIM, T>::end() {
     return data_ + DIM;
 }
 
-template <size_t DIM>
-const double* Vector<DIM>::end() const {
+template <size_t DIM, typename T>
+const T* Vector<DIM, T>::end() const {
     return data_ + DIM;
 }
 
+/**
+ *  Returns the dot (inner) product of lhs and rhs. Preferred over the
+ *  expression version when both operands are Vectors so that the SIMD kernels
+ *  are used.
+ */
+template <size_t DIM, typename T>
+constexpr T operator*(const Vector<DIM, T> &lhs, const Vector<DIM, T> &rhs) {
+    return lhs.dot(rhs);
+}
+
+/**
+ *  Starts the sum at initial.
+ */
+template <size_t DIM, typename T>
+CompensatedSum<Vector<DIM, T> >::CompensatedSum(const Vector<DIM, T> &initial) {
+    for (size_t i = 0; i < DIM; ++i)
+        components_[i] = CompensatedSum<T>(initial[i]);
+}
 
 /**
- *  Returns the result of scaling a copy of v by scale. This free function
- *  guarantees that vector scaling is commutative.
+ *  Adds value component by component and returns the sum for chaining.
  */
-template <size_t DIM>
-const Vector<DIM> operator*(const double &scale, const Vector<DIM> &v) {
-    return v * scale;
+template <size_t DIM, typename T>
+CompensatedSum<Vector<DIM, T> > & CompensatedSum<Vector<DIM, T> >::operator+=(const Vector<DIM, T> &value) {
+    for (size_t i = 0; i < DIM; ++i)
+        components_[i] += value[i];
+    return *this;
 }
 
+/**
+ *  Returns the sum with the accumulated rounding errors added back.
+ */
+template <size_t DIM, typename T>
+Vector<DIM, T> CompensatedSum<Vector<DIM, T> >::sum() const {
+    Vector<DIM, T> total;
+    for (size_t i = 0; i < DIM; ++i)
+        total[i] = components_[i].sum();
+    return total;
+}
 
 #endif
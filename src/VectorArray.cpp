@@ -0,0 +1,346 @@
+/**
+ * @class VectorArray.cpp
+ * @brief A structure of arrays of Vectors with bulk operations
+ * @details Every bulk operation is a plain loop over contiguous columns so
+ * that the compiler can vectorize it
+ *
+ * I affirm that this work is my own
+ * 2016-11-30
+ * @author Edward Goode
+ * VuID: goodees
+ * Email: edward.s.goode@vanderbilt.edu
+ */
+
+#ifndef _VECTOR_ARRAY_CPP_
+#define _VECTOR_ARRAY_CPP_
+
+#include "../include/VectorArray.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+/**
+ *  Creates an array of count zero vectors.
+ */
+template <size_t DIM, typename T>
+VectorArray<DIM, T>::VectorArray(size_t count){
+    resize(count);
+}
+
+/**
+ *  Returns the number of vectors in the array.
+ */
+template <size_t DIM, typename T>
+size_t VectorArray<DIM, T>::size() const{
+    return columns_[0].size();
+}
+
+/**
+ *  Resizes the array to count vectors. New vectors are zero.
+ */
+template <size_t DIM, typename T>
+void VectorArray<DIM, T>::resize(size_t count){
+    for (size_t d = 0; d < DIM; d++)
+        columns_[d].resize(count, T(0));
+}
+
+/**
+ *  Reserves storage for count vectors.
+ */
+template <size_t DIM, typename T>
+void VectorArray<DIM, T>::reserve(size_t count){
+    for (size_t d = 0; d < DIM; d++)
+        columns_[d].reserve(count);
+}
+
+/**
+ *  Appends v to the array.
+ */
+template <size_t DIM, typename T>
+void VectorArray<DIM, T>::push_back(const Vector<DIM, T> &v){
+    for (size_t d = 0; d < DIM; d++)
+        columns_[d].push_back(v[d]);
+}
+
+/**
+ *  Returns the index-th vector. Not range checked.
+ */
+template <size_t DIM, typename T>
+Vector<DIM, T> VectorArray<DIM, T>::operator[](size_t index) const{
+    Vector<DIM, T> v;
+    for (size_t d = 0; d < DIM; d++)
+        v[d] = columns_[d][index];
+    return v;
+}
+
+/**
+ *  Overwrites the index-th vector with v. Not range checked.
+ */
+template <size_t DIM, typename T>
+void VectorArray<DIM, T>::set(size_t index, const Vector<DIM, T> &v){
+    for (size_t d = 0; d < DIM; d++)
+        columns_[d][index] = v[d];
+}
+
+/**
+ *  Returns the contiguous column holding component d of every vector.
+ */
+template <size_t DIM, typename T>
+T * VectorArray<DIM, T>::component(size_t d){
+    return columns_[d].data();
+}
+
+/**
+ *  Returns the contiguous column holding component d of every vector.
+ */
+template <size_t DIM, typename T>
+const T * VectorArray<DIM, T>::component(size_t d) const{
+    return columns_[d].data();
+}
+
+/*******************************************************************************
+*                                                                              *
+*                         B U L K   O P E R A T I O N S                        *
+*                                                                              *
+*******************************************************************************/
+
+/**
+ *  Adds offset to every vector.
+ */
+template <size_t DIM, typename T>
+VectorArray<DIM, T> & VectorArray<DIM, T>::add(const Vector<DIM, T> &offset){
+    const size_t count = size();
+    for (size_t d = 0; d < DIM; d++){
+        T *column = component(d);
+        const T delta = offset[d];
+        for (size_t i = 0; i < count; i++)
+            column[i] += delta;
+    }
+    return *this;
+}
+
+/**
+ *  Adds the vectors of rhs to the vectors of this array element-wise.
+ */
+template <size_t DIM, typename T>
+VectorArray<DIM, T> & VectorArray<DIM, T>::add(const VectorArray<DIM, T> &rhs){
+    return axpy(T(1), rhs);
+}
+
+/**
+ *  Adds the vectors of x scaled by a to the vectors of this array
+ *  element-wise (the BLAS axpy).
+ */
+template <size_t DIM, typename T>
+VectorArray<DIM, T> & VectorArray<DIM, T>::axpy(const T &a, const VectorArray<DIM, T> &x){
+    checkSize(x.size());
+    const size_t count = size();
+    for (size_t d = 0; d < DIM; d++){
+        T *column = component(d);
+        const T *other = x.component(d);
+        for (size_t i = 0; i < count; i++)
+            column[i] = fusedMultiplyAdd(a, other[i], column[i]);
+    }
+    return *this;
+}
+
+/**
+ *  Scales every vector by factor.
+ */
+template <size_t DIM, typename T>
+VectorArray<DIM, T> & VectorArray<DIM, T>::scale(const T &factor){
+    const size_t count = size();
+    for (size_t d = 0; d < DIM; d++){
+        T *column = component(d);
+        for (size_t i = 0; i < count; i++)
+            column[i] *= factor;
+    }
+    return *this;
+}
+
+/**
+ *  Scales every vector such that its magnitude is 1.
+ */
+template <size_t DIM, typename T>
+VectorArray<DIM, T> & VectorArray<DIM, T>::normalize(){
+    std::vector<T> factors;
+    normSq(factors);
+
+    const size_t count = size();
+    for (size_t i = 0; i < count; i++)
+        factors[i] = T(1) / std::sqrt(factors[i]);
+
+    for (size_t d = 0; d < DIM; d++){
+        T *column = component(d);
+        for (size_t i = 0; i < count; i++)
+            column[i] *= factors[i];
+    }
+    return *this;
+}
+
+/**
+ *  Stores the square of the magnitude of every vector in out.
+ */
+template <size_t DIM, typename T>
+void VectorArray<DIM, T>::normSq(std::vector<T> &out) const{
+    dot(*this, out);
+}
+
+/**
+ *  Stores the magnitude of every vector in out.
+ */
+template <size_t DIM, typename T>
+void VectorArray<DIM, T>::norm(std::vector<T> &out) const{
+    normSq(out);
+    for (size_t i = 0; i < out.size(); i++)
+        out[i] = std::sqrt(out[i]);
+}
+
+/**
+ *  Stores the dot product of every vector with the matching vector of rhs
+ *  in out.
+ */
+template <size_t DIM, typename T>
+void VectorArray<DIM, T>::dot(const VectorArray<DIM, T> &rhs, std::vector<T> &out) const{
+    checkSize(rhs.size());
+    const size_t count = size();
+    out.assign(count, T(0));
+
+    // Accumulating one component at a time keeps every loop contiguous.
+    T *result = out.data();
+    for (size_t d = 0; d < DIM; d++){
+        const T *lhs = component(d);
+        const T *other = rhs.component(d);
+        for (size_t i = 0; i < count; i++)
+            result[i] = fusedMultiplyAdd(lhs[i], other[i], result[i]);
+    }
+}
+
+/**
+ *  Returns the sum of all vectors.
+ */
+template <size_t DIM, typename T>
+Vector<DIM, T> VectorArray<DIM, T>::sum() const{
+    Vector<DIM, T> total;
+    for (size_t d = 0; d < DIM; d++)
+        total[d] = columnSum(component(d), nullptr);
+    return total;
+}
+
+/**
+ *  Returns the sum of all vectors, each scaled by the matching weight,
+ *  e.g. masses for a center of mass.
+ */
+template <size_t DIM, typename T>
+Vector<DIM, T> VectorArray<DIM, T>::sum(const std::vector<T> &weights) const{
+    checkSize(weights.size());
+    Vector<DIM, T> total;
+    for (size_t d = 0; d < DIM; d++)
+        total[d] = columnSum(component(d), weights.data());
+    return total;
+}
+
+/**
+ *  Returns the component-wise minimum of all vectors. throws an
+ *  std::domain_error if the array is empty.
+ */
+template <size_t DIM, typename T>
+Vector<DIM, T> VectorArray<DIM, T>::min() const{
+    return extreme([](T low, T value) { return std::min(low, value); });
+}
+
+/**
+ *  Returns the component-wise maximum of all vectors. throws an
+ *  std::domain_error if the array is empty.
+ */
+template <size_t DIM, typename T>
+Vector<DIM, T> VectorArray<DIM, T>::max() const{
+    return extreme([](T high, T value) { return std::max(high, value); });
+}
+
+/**
+ *  Returns the smallest axis-aligned box containing every vector as the
+ *  pair (min(), max()). throws an std::domain_error if the array is empty.
+ */
+template <size_t DIM, typename T>
+std::pair<Vector<DIM, T>, Vector<DIM, T> > VectorArray<DIM, T>::boundingBox() const{
+    if (size() == 0)
+        throw std::domain_error("Empty VectorArray has no bounds");
+
+    const size_t count = size();
+    std::pair<Vector<DIM, T>, Vector<DIM, T> > box;
+    for (size_t d = 0; d < DIM; d++){
+        const T *column = component(d);
+        T low = column[0];
+        T high = column[0];
+        for (size_t i = 1; i < count; i++){
+            low = std::min(low, column[i]);
+            high = std::max(high, column[i]);
+        }
+        box.first[d] = low;
+        box.second[d] = high;
+    }
+    return box;
+}
+
+/**
+ *  Returns the sum of column, with every entry multiplied by the matching
+ *  weight unless weights is null.
+ */
+template <size_t DIM, typename T>
+T VectorArray<DIM, T>::columnSum(const T *column, const T *weights) const{
+    // The compiler may not reorder a floating point sum, so it is split into
+    // independent partial sums that fill a vector register.
+    const size_t lanes = 4;
+    const size_t count = size();
+    const size_t body = count - count % lanes;
+    T partial[lanes] = {};
+
+    if (weights){
+        for (size_t i = 0; i < body; i += lanes)
+            for (size_t k = 0; k < lanes; k++)
+                partial[k] = fusedMultiplyAdd(weights[i + k], column[i + k], partial[k]);
+    } else {
+        for (size_t i = 0; i < body; i += lanes)
+            for (size_t k = 0; k < lanes; k++)
+                partial[k] += column[i + k];
+    }
+
+    T total = (partial[0] + partial[1]) + (partial[2] + partial[3]);
+    for (size_t i = body; i < count; i++)
+        total = weights ? fusedMultiplyAdd(weights[i], column[i], total) : total + column[i];
+    return total;
+}
+
+/**
+ *  Returns the vector whose every component is the result of folding pick
+ *  over that column. throws an std::domain_error if the array is empty.
+ */
+template <size_t DIM, typename T>
+template <typename Pick>
+Vector<DIM, T> VectorArray<DIM, T>::extreme(Pick pick) const{
+    if (size() == 0)
+        throw std::domain_error("Empty VectorArray has no bounds");
+
+    const size_t count = size();
+    Vector<DIM, T> result;
+    for (size_t d = 0; d < DIM; d++){
+        const T *column = component(d);
+        T value = column[0];
+        for (size_t i = 1; i < count; i++)
+            value = pick(value, column[i]);
+        result[d] = value;
+    }
+    return result;
+}
+
+/**
+ *  throws an std::invalid_argument unless count matches size().
+ */
+template <size_t DIM, typename T>
+void VectorArray<DIM, T>::checkSize(size_t count) const{
+    if (count != size())
+        throw std::invalid_argument("VectorArray sizes differ");
+}
+
+#endif
@@ -0,0 +1,238 @@
+#ifndef _VECTOR_EXPRESSION_CPP_
+#define _VECTOR_EXPRESSION_CPP_
+
+#include "../include/VectorExpression.h"
+#include "../include/VectorKernels.h"
+
+#include <cmath>
+
+/**
+ *  Returns the index-th component of the expression. Not range checked.
+ */
+template <size_t DIM, typename T, typename E>
+constexpr T VectorExpression<DIM, T, E>::operator[](size_t index) const {
+    return self()[index];
+}
+
+/**
+ *  Returns the dot (inner) product of this expression and rhs. Outside of
+ *  constant evaluation both are evaluated and passed to the same kernel as
+ *  Vector::dot, so that e.g. (a - b).normSq() equals vector2(a - b).normSq().
+ */
+template <size_t DIM, typename T, typename E>
+template <typename R>
+constexpr T VectorExpression<DIM, T, E>::dot(const VectorExpression<DIM, T, R> &rhs) const {
+    T sum = 0;
+    if (VECTOR_CONSTANT_EVALUATED()) {
+        for (size_t i = 0; i < DIM; ++i)
+            sum += self()[i] * rhs.self()[i];
+        return sum;
+    }
+    T lhsValues[DIM] = {}, rhsValues[DIM] = {};
+    for (size_t i = 0; i < DIM; ++i) {
+        lhsValues[i] = self()[i];
+        rhsValues[i] = rhs.self()[i];
+    }
+    return VectorKernels<DIM, T>::dot(lhsValues, rhsValues);
+}
+
+/**
+ *  Returns the square of the magnitude of this expression.
+ */
+template <size_t DIM, typename T, typename E>
+constexpr T VectorExpression<DIM, T, E>::normSq() const {
+    return dot(*this);
+}
+
+/**
+ *  Returns the magnitude of this expression.
+ */
+template <size_t DIM, typename T, typename E>
+T VectorExpression<DIM, T, E>::norm() const {
+    return std::sqrt(normSq());
+}
+
+/**
+ *  Evaluates this expression and returns the result scaled such that its
+ *  magnitude is 1.
+ */
+template <size_t DIM, typename T, typename E>
+Vector<DIM, T> VectorExpression<DIM, T, E>::normalize() const {
+    Vector<DIM, T> v(*this);
+    v.normalize();
+    return v;
+}
+
+/**
+ *  Returns a human readable representation of this expression.
+ *  Ex. [1 2 3]
+ */
+template <size_t DIM, typename T, typename E>
+std::string VectorExpression<DIM, T, E>::toString() const {
+    return Vector<DIM, T>(*this).toString();
+}
+
+/**
+ *  Returns this expression as its concrete type.
+ */
+template <size_t DIM, typename T, typename E>
+constexpr const E & VectorExpression<DIM, T, E>::self() const {
+    return static_cast<const E &>(*this);
+}
+
+template <size_t DIM, typename T, typename L, typename R>
+constexpr VectorSum<DIM, T, L, R>::VectorSum(const L &lhs, const R &rhs) : lhs_(lhs), rhs_(rhs) {
+}
+
+template <size_t DIM, typename T, typename L, typename R>
+constexpr T VectorSum<DIM, T, L, R>::operator[](size_t index) const {
+    return lhs_[index] + rhs_[index];
+}
+
+template <size_t DIM, typename T, typename L, typename R>
+constexpr VectorDifference<DIM, T, L, R>::VectorDifference(const L &lhs, const R &rhs) : lhs_(lhs), rhs_(rhs) {
+}
+
+template <size_t DIM, typename T, typename L, typename R>
+constexpr T VectorDifference<DIM, T, L, R>::operator[](size_t index) const {
+    return lhs_[index] - rhs_[index];
+}
+
+template <size_t DIM, typename T, typename E>
+constexpr VectorNegation<DIM, T, E>::VectorNegation(const E &operand) : operand_(operand) {
+}
+
+template <size_t DIM, typename T, typename E>
+constexpr T VectorNegation<DIM, T, E>::operator[](size_t index) const {
+    return -operand_[index];
+}
+
+template <size_t DIM, typename T, typename E>
+constexpr VectorScale<DIM, T, E>::VectorScale(const E &operand, T factor) :
+        operand_(operand), factor_(factor) {
+}
+
+template <size_t DIM, typename T, typename E>
+constexpr T VectorScale<DIM, T, E>::operator[](size_t index) const {
+    return operand_[index] * factor_;
+}
+
+/***************************************************************************
+*                                                                          *
+*                  O V E R L O A D E D   O P E R A T O R S                 *
+*                                                                          *
+***************************************************************************/
+
+/**
+ *  Returns true if lhs equals rhs.
+ */
+template <size_t DIM, typename T, typename L, typename R>
+constexpr bool operator==(const VectorExpression<DIM, T, L> &lhs, const VectorExpression<DIM, T, R> &rhs) {
+    for (size_t i = 0; i < DIM; ++i)
+        if (lhs.self()[i] != rhs.self()[i])
+            return false;
+    return true;
+}
+
+/**
+ *  Returns true if lhs differs from rhs.
+ */
+template <size_t DIM, typename T, typename L, typename R>
+constexpr bool operator!=(const VectorExpression<DIM, T, L> &lhs, const VectorExpression<DIM, T, R> &rhs) {
+    return !(lhs == rhs);
+}
+
+/**
+ *  Returns the sum of lhs and rhs.
+ */
+template <size_t DIM, typename T, typename L, typename R>
+constexpr VectorSum<DIM, T, L, R> operator+(const VectorExpression<DIM, T, L> &lhs,
+                                            const VectorExpression<DIM, T, R> &rhs) {
+    return VectorSum<DIM, T, L, R>(lhs.self(), rhs.self());
+}
+
+/**
+ *  Returns the difference between lhs and rhs.
+ */
+template <size_t DIM, typename T, typename L, typename R>
+constexpr VectorDifference<DIM, T, L, R> operator-(const VectorExpression<DIM, T, L> &lhs,
+                                                   const VectorExpression<DIM, T, R> &rhs) {
+    return VectorDifference<DIM, T, L, R>(lhs.self(), rhs.self());
+}
+
+/**
+ *  Returns the additive inverse of v.
+ */
+template <size_t DIM, typename T, typename E>
+constexpr VectorNegation<DIM, T, E> operator-(const VectorExpression<DIM, T, E> &v) {
+    return VectorNegation<DIM, T, E>(v.self());
+}
+
+/**
+ *  Returns v scaled by scale.
+ */
+template <size_t DIM, typename T, typename E>
+constexpr VectorScale<DIM, T, E> operator*(const VectorExpression<DIM, T, E> &v,
+                                           const typename VectorScalar<T>::type &scale) {
+    return VectorScale<DIM, T, E>(v.self(), scale);
+}
+
+/**
+ *  Returns v scaled by scale. This free function guarantees that vector
+ *  scaling is commutative.
+ */
+template <size_t DIM, typename T, typename E>
+constexpr VectorScale<DIM, T, E> operator*(const typename VectorScalar<T>::type &scale,
+                                           const VectorExpression<DIM, T, E> &v) {
+    return v * scale;
+}
+
+/**
+ *  Returns v scaled by 1.0 / scale.
+ */
+template <size_t DIM, typename T, typename E>
+constexpr VectorScale<DIM, T, E> operator/(const VectorExpression<DIM, T, E> &v,
+                                           const typename VectorScalar<T>::type &scale) {
+    return v * (T(1) / scale);
+}
+
+/**
+ *  Returns the dot (inner) product of lhs and rhs.
+ */
+template <size_t DIM, typename T, typename L, typename R>
+constexpr T operator*(const VectorExpression<DIM, T, L> &lhs, const VectorExpression<DIM, T, R> &rhs) {
+    return lhs.dot(rhs);
+}
+
+/**
+ *  Returns the cross product of lhs and rhs if called on 3D vectors.
+ *  throws an std::domain_error otherwise.
+ */
+template <size_t DIM, typename T, typename L, typename R>
+constexpr Vector<DIM, T> operator^(const VectorExpression<DIM, T, L> &lhs,
+                                   const VectorExpression<DIM, T, R> &rhs) {
+    return Vector<DIM, T>(lhs).cross(Vector<DIM, T>(rhs));
+}
+
+/**
+ *  Returns the dot (inner) product of lhs and rhs accumulated in type A. The
+ *  operands may have different scalar types, e.g. two float vectors can be
+ *  multiplied and summed in double.
+ */
+template <typename A, size_t DIM, typename T, typename U, typename L, typename R>
+constexpr A dotAs(const VectorExpression<DIM, T, L> &lhs, const VectorExpression<DIM, U, R> &rhs) {
+    A sum = 0;
+    for (size_t i = 0; i < DIM; ++i)
+        sum += static_cast<A>(lhs.self()[i]) * static_cast<A>(rhs.self()[i]);
+    return sum;
+}
+
+/**
+ *  Returns the square of the magnitude of v accumulated in type A.
+ */
+template <typename A, size_t DIM, typename T, typename E>
+constexpr A normSqAs(const VectorExpression<DIM, T, E> &v) {
+    return dotAs<A>(v, v);
+}
+
+#endif
@@ -0,0 +1,283 @@
+#ifndef _VECTOR_KERNELS_CPP_
+#define _VECTOR_KERNELS_CPP_
+
+#include "../include/VectorKernels.h"
+#include "../include/VectorHelpers.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+
+#if defined(VECTOR_SIMD)
+#include <emmintrin.h>
+#if defined(__AVX__) || defined(__FMA__)
+#include <immintrin.h>
+#endif
+#endif
+
+/*******************************************************************************
+*                                                                              *
+*                         G E N E R I C   K E R N E L S                        *
+*                                                                              *
+*******************************************************************************/
+
+/**
+ *  Stores lhs + rhs in out.
+ */
+template <size_t DIM, typename T>
+void VectorKernels<DIM, T>::add(const T *lhs, const T *rhs, T *out) {
+    std::transform(lhs, lhs + DIM, rhs, out, adder<T>());
+}
+
+/**
+ *  Stores lhs - rhs in out.
+ */
+template <size_t DIM, typename T>
+void VectorKernels<DIM, T>::subtract(const T *lhs, const T *rhs, T *out) {
+    std::transform(lhs, lhs + DIM, rhs, out, std::minus<T>());
+}
+
+/**
+ *  Stores v * factor in out.
+ */
+template <size_t DIM, typename T>
+void VectorKernels<DIM, T>::scale(const T *v, T factor, T *out) {
+    // Via a binder, we can reuse multiplier with a transform
+    std::transform(v, v + DIM, out, std::bind2nd(multiplier<T>(), factor));
+}
+
+/**
+ *  Stores a * x + y in out, fused where the hardware allows it.
+ */
+template <size_t DIM, typename T>
+void VectorKernels<DIM, T>::axpy(T a, const T *x, const T *y, T *out) {
+    std::transform(x, x + DIM, y, out, scaled_adder<T>(a));
+}
+
+/**
+ *  Returns the dot (inner) product of lhs and rhs, accumulated with fused
+ *  multiply-adds where the hardware allows it.
+ */
+template <size_t DIM, typename T>
+T VectorKernels<DIM, T>::dot(const T *lhs, const T *rhs) {
+    T sum = 0;
+    for (size_t i = 0; i < DIM; ++i)
+        sum = fusedMultiplyAdd(lhs[i], rhs[i], sum);
+    return sum;
+}
+
+/**
+ *  Scales v in place such that its magnitude is 1.
+ */
+template <size_t DIM, typename T>
+void VectorKernels<DIM, T>::normalize(T *v) {
+    scale(v, T(1) / std::sqrt(dot(v, v)), v);
+}
+
+/**
+ *  Returns 1 / sqrt(x) computed as selected by precision. The estimate comes
+ *  from rsqrtss where SSE is available and otherwise from the integer shift
+ *  trick followed by one Newton-Raphson step, which is a few bits less
+ *  accurate. Values outside the range of float are always computed exactly.
+ */
+template <typename T>
+T inverseSqrt(T x, NormPrecision precision) {
+    if (precision == NormPrecision::exact || !(x >= FLT_MIN && x <= FLT_MAX))
+        return T(1) / std::sqrt(x);
+
+    const T half = T(0.5) * x;
+#if defined(VECTOR_SIMD)
+    T y = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(static_cast<float>(x))));
+#else
+    // Halving the exponent through the bit pattern gives about 5 bits and one
+    // Newton step about 9, against the 12 bits of rsqrtss.
+    float f = static_cast<float>(x);
+    uint32_t bits;
+    std::memcpy(&bits, &f, sizeof(bits));
+    bits = 0x5f375a86 - (bits >> 1);
+    std::memcpy(&f, &bits, sizeof(f));
+    T y = f;
+    y = y * (T(1.5) - half * y * y);
+#endif
+
+    if (precision == NormPrecision::refined)
+        y = y * (T(1.5) - half * y * y);
+    return y;
+}
+
+#if defined(VECTOR_SIMD)
+
+/*******************************************************************************
+*                                                                              *
+*                          S I M D   K E R N E L S                             *
+*                                                                              *
+*******************************************************************************/
+
+/**
+ *  Returns the sum of the two lanes of v.
+ */
+inline double simdHorizontalSum(__m128d v) {
+    return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v)));
+}
+
+/**
+ *  Returns a * x + y for packed doubles, with a single rounding when the
+ *  target has FMA.
+ */
+inline __m128d simdMultiplyAdd(__m128d a, __m128d x, __m128d y) {
+#if defined(__FMA__)
+    return _mm_fmadd_pd(a, x, y);
+#else
+    return _mm_add_pd(_mm_mul_pd(a, x), y);
+#endif
+}
+
+/**
+ *  Returns a * x + y, with a single rounding when the target has FMA.
+ */
+inline double simdMultiplyAdd(double a, double x, double y) {
+#if defined(__FMA__)
+    return _mm_cvtsd_f64(_mm_fmadd_sd(_mm_set_sd(a), _mm_set_sd(x), _mm_set_sd(y)));
+#else
+    return a * x + y;
+#endif
+}
+
+/**
+ *  Returns 1 / sqrt(normSq) without going through the errno-setting libm call.
+ */
+inline double simdInverseNorm(double normSq) {
+    return 1.0 / _mm_cvtsd_f64(_mm_sqrt_sd(_mm_setzero_pd(), _mm_set_sd(normSq)));
+}
+
+inline void VectorKernels<2, double>::add(const double *lhs, const double *rhs, double *out) {
+    _mm_storeu_pd(out, _mm_add_pd(_mm_loadu_pd(lhs), _mm_loadu_pd(rhs)));
+}
+
+inline void VectorKernels<2, double>::subtract(const double *lhs, const double *rhs, double *out) {
+    _mm_storeu_pd(out, _mm_sub_pd(_mm_loadu_pd(lhs), _mm_loadu_pd(rhs)));
+}
+
+inline void VectorKernels<2, double>::scale(const double *v, double factor, double *out) {
+    _mm_storeu_pd(out, _mm_mul_pd(_mm_loadu_pd(v), _mm_set1_pd(factor)));
+}
+
+inline void VectorKernels<2, double>::axpy(double a, const double *x, const double *y, double *out) {
+    _mm_storeu_pd(out, simdMultiplyAdd(_mm_set1_pd(a), _mm_loadu_pd(x), _mm_loadu_pd(y)));
+}
+
+inline double VectorKernels<2, double>::dot(const double *lhs, const double *rhs) {
+    return simdMultiplyAdd(lhs[1], rhs[1], lhs[0] * rhs[0]);
+}
+
+inline void VectorKernels<2, double>::normalize(double *v) {
+    __m128d x = _mm_loadu_pd(v);
+    double factor = simdInverseNorm(simdHorizontalSum(_mm_mul_pd(x, x)));
+    _mm_storeu_pd(v, _mm_mul_pd(x, _mm_set1_pd(factor)));
+}
+
+inline void VectorKernels<3, double>::add(const double *lhs, const double *rhs, double *out) {
+    _mm_storeu_pd(out, _mm_add_pd(_mm_loadu_pd(lhs), _mm_loadu_pd(rhs)));
+    out[2] = lhs[2] + rhs[2];
+}
+
+inline void VectorKernels<3, double>::subtract(const double *lhs, const double *rhs, double *out) {
+    _mm_storeu_pd(out, _mm_sub_pd(_mm_loadu_pd(lhs), _mm_loadu_pd(rhs)));
+    out[2] = lhs[2] - rhs[2];
+}
+
+inline void VectorKernels<3, double>::scale(const double *v, double factor, double *out) {
+    _mm_storeu_pd(out, _mm_mul_pd(_mm_loadu_pd(v), _mm_set1_pd(factor)));
+    out[2] = v[2] * factor;
+}
+
+inline void VectorKernels<3, double>::axpy(double a, const double *x, const double *y, double *out) {
+    _mm_storeu_pd(out, simdMultiplyAdd(_mm_set1_pd(a), _mm_loadu_pd(x), _mm_loadu_pd(y)));
+    out[2] = simdMultiplyAdd(a, x[2], y[2]);
+}
+
+inline double VectorKernels<3, double>::dot(const double *lhs, const double *rhs) {
+    return simdMultiplyAdd(lhs[2], rhs[2], simdMultiplyAdd(lhs[1], rhs[1], lhs[0] * rhs[0]));
+}
+
+inline void VectorKernels<3, double>::normalize(double *v) {
+    scale(v, simdInverseNorm(dot(v, v)), v);
+}
+
+#if defined(__AVX__)
+
+/**
+ *  Returns the sum of the four lanes of v.
+ */
+inline double simdHorizontalSum(__m256d v) {
+    return simdHorizontalSum(_mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1)));
+}
+
+inline void VectorKernels<4, double>::add(const double *lhs, const double *rhs, double *out) {
+    _mm256_storeu_pd(out, _mm256_add_pd(_mm256_loadu_pd(lhs), _mm256_loadu_pd(rhs)));
+}
+
+inline void VectorKernels<4, double>::subtract(const double *lhs, const double *rhs, double *out) {
+    _mm256_storeu_pd(out, _mm256_sub_pd(_mm256_loadu_pd(lhs), _mm256_loadu_pd(rhs)));
+}
+
+inline void VectorKernels<4, double>::scale(const double *v, double factor, double *out) {
+    _mm256_storeu_pd(out, _mm256_mul_pd(_mm256_loadu_pd(v), _mm256_set1_pd(factor)));
+}
+
+inline void VectorKernels<4, double>::axpy(double a, const double *x, const double *y, double *out) {
+#if defined(__FMA__)
+    _mm256_storeu_pd(out, _mm256_fmadd_pd(_mm256_set1_pd(a), _mm256_loadu_pd(x), _mm256_loadu_pd(y)));
+#else
+    __m256d product = _mm256_mul_pd(_mm256_set1_pd(a), _mm256_loadu_pd(x));
+    _mm256_storeu_pd(out, _mm256_add_pd(product, _mm256_loadu_pd(y)));
+#endif
+}
+
+inline double VectorKernels<4, double>::dot(const double *lhs, const double *rhs) {
+    // Pairs the low and high halves so that half of the sums are fused.
+    __m128d low = _mm_mul_pd(_mm_loadu_pd(lhs), _mm_loadu_pd(rhs));
+    return simdHorizontalSum(simdMultiplyAdd(_mm_loadu_pd(lhs + 2), _mm_loadu_pd(rhs + 2), low));
+}
+
+#else
+
+inline void VectorKernels<4, double>::add(const double *lhs, const double *rhs, double *out) {
+    _mm_storeu_pd(out, _mm_add_pd(_mm_loadu_pd(lhs), _mm_loadu_pd(rhs)));
+    _mm_storeu_pd(out + 2, _mm_add_pd(_mm_loadu_pd(lhs + 2), _mm_loadu_pd(rhs + 2)));
+}
+
+inline void VectorKernels<4, double>::subtract(const double *lhs, const double *rhs, double *out) {
+    _mm_storeu_pd(out, _mm_sub_pd(_mm_loadu_pd(lhs), _mm_loadu_pd(rhs)));
+    _mm_storeu_pd(out + 2, _mm_sub_pd(_mm_loadu_pd(lhs + 2), _mm_loadu_pd(rhs + 2)));
+}
+
+inline void VectorKernels<4, double>::scale(const double *v, double factor, double *out) {
+    __m128d f = _mm_set1_pd(factor);
+    _mm_storeu_pd(out, _mm_mul_pd(_mm_loadu_pd(v), f));
+    _mm_storeu_pd(out + 2, _mm_mul_pd(_mm_loadu_pd(v + 2), f));
+}
+
+inline void VectorKernels<4, double>::axpy(double a, const double *x, const double *y, double *out) {
+    __m128d factor = _mm_set1_pd(a);
+    _mm_storeu_pd(out, simdMultiplyAdd(factor, _mm_loadu_pd(x), _mm_loadu_pd(y)));
+    _mm_storeu_pd(out + 2, simdMultiplyAdd(factor, _mm_loadu_pd(x + 2), _mm_loadu_pd(y + 2)));
+}
+
+inline double VectorKernels<4, double>::dot(const double *lhs, const double *rhs) {
+    __m128d low = _mm_mul_pd(_mm_loadu_pd(lhs), _mm_loadu_pd(rhs));
+    return simdHorizontalSum(simdMultiplyAdd(_mm_loadu_pd(lhs + 2), _mm_loadu_pd(rhs + 2), low));
+}
+
+#endif
+
+inline void VectorKernels<4, double>::normalize(double *v) {
+    scale(v, simdInverseNorm(dot(v, v)), v);
+}
+
+#endif
+
+#endif
@@ -0,0 +1,86 @@
+/*
+ * Edward Goode @2016
+ */
+#include <stdexcept>
+#include <vector>
+#include <gtest/gtest.h>
+#include "../include/BatchedUniverse.h"
+#include "../include/Ensemble.h"
+#include "../include/Object.h"
+#include "../include/ObjectFactory.h"
+#include "../include/Universe.h"
+#include "./testHelper.h"
+
+
+// The fixture for testing the lockstep ensemble engine.
+class BatchedUniverseTest : public ::testing::Test {};
+
+namespace {
+/**
+ *  Steps a batch of perturbed sun, earth and moon systems summed with
+ *  summation next to scalar Universes and expects every lane to match its
+ *  Universe bit for bit.
+ */
+void expectLanesMatch(Summation summation) {
+    Universe scene;
+    scene.setSummation(summation);
+    scene.addObject(ObjectFactory::makeObject("sun", 1.98892e30));
+    scene.addObject(ObjectFactory::makeObject("earth", 5.9742e24,
+                                              makeVector2(149597870700.0, 0), makeVector2(0, 29788.4676)));
+    scene.addObject(ObjectFactory::makeObject("moon", 7.342e22,
+                                              makeVector2(149597870700.0 + 384399000.0, 0), makeVector2(0, 29788.4676 + 1022)));
+
+    const size_t lanes = 4;
+    BatchedUniverse<lanes> batch(scene);
+    EXPECT_EQ(batch.size(), 3u);
+    EXPECT_EQ(batch.getName(2), "moon");
+    EXPECT_EQ(batch.getSummation(), summation);
+
+    // Give every lane its own perturbed copy and keep a scalar reference.
+    Ensemble::Perturbation perturb = Ensemble::velocityNoise(1e-4, 7);
+    std::vector<Universe*> members;
+    for (size_t lane = 0; lane < lanes; ++lane) {
+        members.push_back(new Universe());
+        members[lane]->setSummation(summation);
+        std::vector<Object*> bodies = scene.getSnapshot();
+        members[lane]->swap(bodies);
+        perturb(lane, *members[lane]);
+        batch.loadLane(lane, *members[lane]);
+    }
+
+    for (int step = 0; step < 1000; ++step) {
+        batch.stepSimulation(60);
+        for (Universe *member : members)
+            member->stepSimulation(60);
+    }
+
+    for (size_t lane = 0; lane < lanes; ++lane) {
+        size_t body = 0;
+        for (const Object *obj : *members[lane]) {
+            EXPECT_EQ(batch.getPosition(body, lane)[0], obj->getPosition()[0]);
+            EXPECT_EQ(batch.getPosition(body, lane)[1], obj->getPosition()[1]);
+            EXPECT_EQ(batch.getVelocity(body, lane)[0], obj->getVelocity()[0]);
+            EXPECT_EQ(batch.getVelocity(body, lane)[1], obj->getVelocity()[1]);
+            body++;
+        }
+    }
+    EXPECT_NE(batch.getPosition(1, 0), batch.getPosition(1, 1));
+
+    batch.storeLane(3, *members[0]);
+    EXPECT_EQ((**(++members[0]->begin())).getPosition(), batch.getPosition(1, 3));
+
+    Universe empty;
+    EXPECT_THROW(batch.loadLane(0, empty), std::invalid_argument);
+
+    for (Universe *member : members)
+        delete member;
+}
+}
+
+TEST_F(BatchedUniverseTest, LanesMatchUniverse) {
+    expectLanesMatch(Summation::naive);
+}
+
+TEST_F(BatchedUniverseTest, CompensatedLanesMatchUniverse) {
+    expectLanesMatch(Summation::compensated);
+}
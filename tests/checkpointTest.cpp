@@ -0,0 +1,157 @@
+/*
+ * Edward Goode @2016
+ */
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <gtest/gtest.h>
+#include "../include/Checkpoint.h"
+#include "../include/CheckpointWriter.h"
+#include "../include/Object.h"
+#include "../include/ObjectFactory.h"
+#include "../include/Universe.h"
+#include "./testHelper.h"
+
+// The fixture for testing class Checkpoint.
+class CheckpointTest : public ::testing::Test {};
+
+namespace {
+const char *path = "checkpointTest.chk";
+
+void makeScene(Universe &universe) {
+    universe.addObject(ObjectFactory::makeObject("sun", 1.98892e30));
+    universe.addObject(ObjectFactory::makeObject("earth", 5.9742e24, makeVector2(149597870700.0, 0),
+                                                 makeVector2(0, 29788.4676)));
+    universe.addObject(ObjectFactory::makeObject("mars", 6.4171e23, makeVector2(0, -227939200000.0),
+                                                 makeVector2(24077, 0)));
+}
+
+void expectIdentical(const Universe &expected, const Universe &actual) {
+    ASSERT_EQ(std::distance(expected.begin(), expected.end()), std::distance(actual.begin(), actual.end()));
+    for (Universe::const_iterator i = expected.begin(), j = actual.begin(); i != expected.end(); ++i, ++j) {
+        EXPECT_EQ((*i)->getName(), (*j)->getName());
+        EXPECT_EQ((*i)->getMass(), (*j)->getMass());
+        EXPECT_EQ((*i)->getPosition(), (*j)->getPosition());
+        EXPECT_EQ((*i)->getVelocity(), (*j)->getVelocity());
+    }
+    EXPECT_EQ(expected.getStepCount(), actual.getStepCount());
+    EXPECT_EQ(expected.getTime(), actual.getTime());
+    EXPECT_EQ(expected.getSummation(), actual.getSummation());
+}
+}
+
+TEST_F(CheckpointTest, RestartIsBitExact) {
+    Universe original;
+    makeScene(original);
+    original.setSummation(Summation::compensated);
+    for (int step = 0; step < 500; ++step)
+        original.stepSimulation(3600 + 0.1 * step);
+    Checkpoint::save(path, original);
+
+    // The restored run replaces whatever was there before.
+    Universe restored;
+    restored.addObject(ObjectFactory::makeObject("stale"));
+    Checkpoint::restore(path, restored);
+    expectIdentical(original, restored);
+
+    for (int step = 500; step < 1000; ++step) {
+        original.stepSimulation(3600 + 0.1 * step);
+        restored.stepSimulation(3600 + 0.1 * step);
+    }
+    expectIdentical(original, restored);
+
+    // Published states resume on schedule.
+    original.setPublishInterval(7);
+    Checkpoint checkpoint;
+    checkpoint.capture(original);
+    checkpoint.write(path);
+    Checkpoint loaded;
+    loaded.read(path);
+    EXPECT_EQ(loaded.size(), 3u);
+    EXPECT_EQ(loaded.getStepCount(), 1000u);
+    loaded.apply(restored);
+    for (int step = 0; step < 5; ++step)
+        restored.stepSimulation(1);
+    ASSERT_NE(restored.getState(), nullptr);
+    EXPECT_EQ(restored.getState()->step, 1001u);
+    std::remove(path);
+}
+
+TEST_F(CheckpointTest, RejectsInvalidFiles) {
+    Universe universe;
+    makeScene(universe);
+    Checkpoint::save(path, universe);
+
+    std::string contents;
+    {
+        std::ifstream file(path, std::ios::binary);
+        contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << contents.substr(0, contents.size() - 8);
+    }
+
+    Universe target;
+    makeScene(target);
+    target.stepSimulation(1);
+    EXPECT_THROW(Checkpoint::restore(path, target), std::runtime_error);
+    EXPECT_THROW(Checkpoint::restore("../tests/UCMtest.txt", target), std::runtime_error);
+    EXPECT_THROW(Checkpoint::restore("../tests/missing.chk", target), std::runtime_error);
+    // A failed restore leaves the Universe untouched.
+    EXPECT_EQ(target.getStepCount(), 1u);
+    EXPECT_EQ(std::distance(target.begin(), target.end()), 3);
+
+    // A failed read leaves a reused checkpoint untouched. The header is 64
+    // bytes and is followed by the name offsets.
+    Universe pair;
+    pair.addObject(ObjectFactory::makeObject("sun", 1.98892e30));
+    pair.addObject(ObjectFactory::makeObject("earth", 5.9742e24));
+    Checkpoint checkpoint;
+    checkpoint.capture(pair);
+    contents[64 + 2 * 8 + 7] = 0x7f;
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << contents;
+    }
+    EXPECT_THROW(checkpoint.read(path), std::runtime_error);
+    EXPECT_EQ(checkpoint.size(), 2u);
+    checkpoint.apply(target);
+    EXPECT_EQ(std::distance(target.begin(), target.end()), 2);
+    EXPECT_EQ((**(++target.begin())).getName(), "earth");
+    std::remove(path);
+}
+
+TEST_F(CheckpointTest, BackgroundWriter) {
+    const char *paths[] = {"checkpointTest0.chk", "checkpointTest1.chk", "checkpointTest2.chk"};
+    Universe universe;
+    makeScene(universe);
+
+    // Saved faster than they can be written, so save has to wait for a
+    // free buffer at times.
+    Checkpoint expected[3];
+    CheckpointWriter writer;
+    for (int i = 0; i < 3; ++i) {
+        for (int step = 0; step < 50; ++step)
+            universe.stepSimulation(3600);
+        writer.save(paths[i], universe);
+        expected[i].capture(universe);
+    }
+    writer.wait();
+
+    for (int i = 0; i < 3; ++i) {
+        Universe fromWriter, fromCapture;
+        Checkpoint::restore(paths[i], fromWriter);
+        expected[i].apply(fromCapture);
+        EXPECT_EQ(fromWriter.getStepCount(), 50u * (i + 1));
+        expectIdentical(fromCapture, fromWriter);
+        std::remove(paths[i]);
+    }
+
+    // Errors of the writer thread are reported on the simulation thread.
+    writer.save("missing/directory/checkpoint.chk", universe);
+    EXPECT_THROW(writer.wait(), std::runtime_error);
+    EXPECT_NO_THROW(writer.wait());
+}
@@ -0,0 +1,123 @@
+/*
+ * Edward Goode @2016
+ */
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include <gtest/gtest.h>
+#include "../include/Ensemble.h"
+#include "../include/Object.h"
+#include "../include/ObjectFactory.h"
+#include "../include/ThreadPool.h"
+#include "../include/Universe.h"
+#include "./testHelper.h"
+
+
+// The fixture for testing the thread pool and ensemble runner.
+class EnsembleTest : public ::testing::Test {};
+
+TEST_F(EnsembleTest, ThreadPool) {
+    ThreadPool pool(4);
+    EXPECT_EQ(pool.size(), 4u);
+
+    std::atomic<int> count(0);
+    for (int i = 0; i < 100; ++i)
+        pool.submit([&count]() { count++; });
+    pool.wait();
+    EXPECT_EQ(count, 100);
+
+    pool.submit([]() { throw std::runtime_error("task failed"); });
+    EXPECT_THROW(pool.wait(), std::runtime_error);
+
+    // The pool remains usable after a failed task.
+    pool.submit([&count]() { count++; });
+    pool.wait();
+    EXPECT_EQ(count, 101);
+}
+
+TEST_F(EnsembleTest, Batches) {
+    ThreadPool pool(2);
+    std::atomic<int> count(0);
+
+    // A batch neither waits for nor reports the failures of other tasks.
+    pool.submit([]() { throw std::runtime_error("other client"); });
+    {
+        ThreadPool::Batch batch(pool);
+        for (int i = 0; i < 10; ++i)
+            batch.submit([&count]() { count++; });
+        batch.wait();
+        EXPECT_EQ(count, 10);
+
+        batch.submit([]() { throw std::invalid_argument("own task"); });
+        EXPECT_THROW(batch.wait(), std::invalid_argument);
+    }
+    EXPECT_THROW(pool.wait(), std::runtime_error);
+
+    // Batches waited for inside tasks cannot starve the workers.
+    ThreadPool::Batch outer(pool);
+    for (int i = 0; i < 4; ++i)
+        outer.submit([&pool, &count]() {
+            ThreadPool::Batch inner(pool);
+            for (int j = 0; j < 10; ++j)
+                inner.submit([&count]() { count++; });
+            inner.wait();
+        });
+    outer.wait();
+    EXPECT_EQ(count, 50);
+}
+
+TEST_F(EnsembleTest, VelocityNoiseStreams) {
+    Universe scene;
+    scene.addObject(ObjectFactory::makeObject("sun", 1.98892e30));
+    scene.addObject(ObjectFactory::makeObject("earth", 5.9742e24,
+                                              makeVector2(149597870700.0, 0), makeVector2(0, 29788.4676)));
+
+    // Member 1 of seed 1 and member 0 of seed 2 draw from different streams.
+    std::vector<Object*> first = scene.getSnapshot(), second = scene.getSnapshot();
+    Universe a, b;
+    a.swap(first);
+    b.swap(second);
+    Ensemble::velocityNoise(1e-3, 1)(1, a);
+    Ensemble::velocityNoise(1e-3, 2)(0, b);
+    EXPECT_NE((**(++a.begin())).getVelocity(), (**(++b.begin())).getVelocity());
+}
+
+TEST_F(EnsembleTest, MembersMatchSerialRuns) {
+    Universe scene;
+    scene.addObject(ObjectFactory::makeObject("sun", 1.98892e30));
+    scene.addObject(ObjectFactory::makeObject("earth", 5.9742e24,
+                                              makeVector2(149597870700.0, 0), makeVector2(0, 29788.4676)));
+
+    const size_t members = 16;
+    const size_t steps = 500;
+    Ensemble::Perturbation perturb = Ensemble::velocityNoise(1e-3, 42);
+    Ensemble ensemble(scene, perturb);
+
+    ThreadPool pool(4);
+    std::vector<MemberSummary> summaries(members);
+    std::vector<int> seen(members, 0);
+    ensemble.run(members, steps, 60, pool, [&](const MemberSummary &summary) {
+        summaries[summary.member] = summary;
+        seen[summary.member]++;
+    });
+
+    for (size_t member = 0; member < members; ++member) {
+        ASSERT_EQ(seen[member], 1);
+
+        // Reproduce the member serially and expect bit-identical results.
+        Universe serial;
+        std::vector<Object*> bodies = scene.getSnapshot();
+        serial.swap(bodies);
+        perturb(member, serial);
+        for (size_t step = 0; step < steps; ++step)
+            serial.stepSimulation(60);
+
+        const UniverseState &state = *summaries[member].finalState;
+        EXPECT_EQ(state.step, steps);
+        EXPECT_EQ(state.positions[1], (**(++serial.begin())).getPosition());
+        EXPECT_NEAR(summaries[member].finalEnergy / summaries[member].initialEnergy, 1.0, 1e-3);
+    }
+
+    EXPECT_NE(summaries[0].finalState->positions[1], summaries[1].finalState->positions[1]);
+}
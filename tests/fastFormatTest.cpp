@@ -0,0 +1,104 @@
+/*
+ * Edward Goode @2016
+ */
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+#include <gtest/gtest.h>
+#include "../include/FastFormat.h"
+#include "../include/Vector.h"
+
+// The fixture for testing class FastFormat.
+class FastFormatTest : public ::testing::Test {};
+
+namespace {
+template <typename T>
+std::string format(T value) {
+    char buffer[FastFormat::maxLength];
+    return std::string(buffer, FastFormat::format(value, buffer));
+}
+}
+
+TEST_F(FastFormatTest, Notation) {
+    EXPECT_EQ(format(0.0), "0");
+    EXPECT_EQ(format(-0.0), "-0");
+    EXPECT_EQ(format(1.0), "1");
+    EXPECT_EQ(format(-2.5), "-2.5");
+    EXPECT_EQ(format(0.1), "0.1");
+    EXPECT_EQ(format(0.3), "0.3");
+    EXPECT_EQ(format(0.1 + 0.2), "0.30000000000000004");
+    EXPECT_EQ(format(123.456), "123.456");
+    EXPECT_EQ(format(149597870700.0), "149597870700");
+    EXPECT_EQ(format(29788.4676), "29788.4676");
+    EXPECT_EQ(format(1.98892e30), "1.98892e+30");
+    EXPECT_EQ(format(6.67428e-11), "6.67428e-11");
+    EXPECT_EQ(format(1e20), "100000000000000000000");
+    EXPECT_EQ(format(1e21), "1e+21");
+    EXPECT_EQ(format(0.000001), "0.000001");
+    EXPECT_EQ(format(1e-7), "1e-7");
+    EXPECT_EQ(format(5e-324), "5e-324");
+    EXPECT_EQ(format(DBL_MAX), "1.7976931348623157e+308");
+    EXPECT_EQ(format(DBL_MIN), "2.2250738585072014e-308");
+    EXPECT_EQ(format(std::numeric_limits<double>::infinity()), "inf");
+    EXPECT_EQ(format(-std::numeric_limits<double>::infinity()), "-inf");
+    EXPECT_EQ(format(std::numeric_limits<double>::quiet_NaN()), "nan");
+
+    // Floats get the shortest text for float, not for the widened double.
+    EXPECT_EQ(format(0.1f), "0.1");
+    EXPECT_EQ(format(16777216.0f), "16777216");
+    EXPECT_EQ(format(FLT_MAX), "3.4028235e+38");
+    EXPECT_EQ(format(0.5L), "0.5");
+}
+
+TEST_F(FastFormatTest, RoundTrip) {
+    std::mt19937_64 random(2016);
+    char buffer[FastFormat::maxLength + 1];
+    for (int i = 0; i < 200000; ++i) {
+        uint64_t bits = random();
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        if (std::isnan(value))
+            continue;
+
+        char *end = FastFormat::format(value, buffer);
+        *end = '\0';
+        ASSERT_EQ(std::strtod(buffer, nullptr), value) << buffer;
+
+        // Never longer than the 17 significant digits that always suffice.
+        char reference[32];
+        std::snprintf(reference, sizeof(reference), "%.17g", value);
+        ASSERT_LE(end - buffer, static_cast<long>(std::strlen(reference)) + 2) << buffer;
+
+        float narrow;
+        uint32_t narrowBits = static_cast<uint32_t>(bits);
+        std::memcpy(&narrow, &narrowBits, sizeof(narrow));
+        if (std::isnan(narrow))
+            continue;
+        *FastFormat::format(narrow, buffer) = '\0';
+        ASSERT_EQ(std::strtof(buffer, nullptr), narrow) << buffer;
+    }
+
+    long double third = 1.0L / 3;
+    *FastFormat::format(third, buffer) = '\0';
+    EXPECT_EQ(std::strtold(buffer, nullptr), third);
+}
+
+TEST_F(FastFormatTest, VectorText) {
+    const double data[] = {149597870700.0, -0.0, 1.98892e30};
+    vector3 v(data);
+    EXPECT_EQ(v.toString(), "[149597870700 -0 1.98892e+30]");
+
+    char buffer[vector3::maxStringLength];
+    EXPECT_EQ(std::string(buffer, v.appendTo(buffer)), v.toString());
+
+    std::string out = "p=";
+    v.appendTo(out);
+    FastFormat::append(0.25, out);
+    EXPECT_EQ(out, "p=[149597870700 -0 1.98892e+30]0.25");
+}
@@ -0,0 +1,119 @@
+/*
+ * Edward Goode @2016
+ */
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include <gtest/gtest.h>
+#include "../include/Object.h"
+#include "../include/ObjectFactory.h"
+#include "../include/Parareal.h"
+#include "../include/ThreadPool.h"
+#include "../include/Universe.h"
+#include "../include/UniverseObserver.h"
+#include "./testHelper.h"
+
+
+namespace {
+/**
+ *  Remembers the step counts and times it was notified at.
+ */
+class StepLog : public UniverseObserver {
+public:
+    void stepped(const Universe &universe) {
+        steps.push_back(universe.getStepCount());
+        times.push_back(universe.getTime());
+    }
+
+    std::vector<size_t> steps;
+    std::vector<double> times;
+};
+}
+
+// The fixture for testing time-parallel integration.
+class PararealTest : public ::testing::Test {
+protected:
+    /**
+     *  Populates universe with a sun, the earth, and a comet.
+     */
+    void makeScene(Universe &universe) {
+        universe.addObject(ObjectFactory::makeObject("sun", 1.98892e30));
+        universe.addObject(ObjectFactory::makeObject("earth", 5.9742e24,
+                                                     makeVector2(149597870700.0, 0), makeVector2(0, 29788.4676)));
+        universe.addObject(ObjectFactory::makeObject("comet", 1e14,
+                                                     makeVector2(0, -2e11), makeVector2(20000, 5000)));
+    }
+};
+
+TEST_F(PararealTest, ConvergesToFineSolution) {
+    const double fineStep = 60;
+    const double duration = 8 * 86400;
+    const size_t slices = 8;
+
+    Universe serial;
+    makeScene(serial);
+    for (int step = 0; step < duration / fineStep; ++step)
+        serial.stepSimulation(fineStep);
+
+    ThreadPool pool(4);
+
+    // With a zero tolerance parareal iterates until it reproduces the serial
+    // run, which takes at most one iteration per slice.
+    Universe exact;
+    makeScene(exact);
+    Parareal full(fineStep, 6 * 3600, 0.0, slices);
+    EXPECT_LE(full.integrate(exact, duration, slices, pool), slices);
+    EXPECT_EQ(exact.getStepCount(), serial.getStepCount());
+    EXPECT_DOUBLE_EQ(exact.getTime(), serial.getTime());
+    for (Universe::iterator s = serial.begin(), p = exact.begin(); s != serial.end(); ++s, ++p) {
+        EXPECT_EQ((*p)->getPosition(), (*s)->getPosition());
+        EXPECT_EQ((*p)->getVelocity(), (*s)->getVelocity());
+    }
+
+    // A loose tolerance stops early, close to the serial run.
+    Universe approx;
+    makeScene(approx);
+    Parareal loose(fineStep, 6 * 3600, 1e-7, slices);
+    EXPECT_LT(loose.integrate(approx, duration, slices, pool), slices);
+    for (Universe::iterator s = serial.begin(), p = approx.begin(); s != serial.end(); ++s, ++p)
+        assertVector((*p)->getPosition(), (*s)->getPosition(), 1e-6 * (*s)->getPosition().norm() + 1);
+}
+
+TEST_F(PararealTest, NotifiesAtSliceBoundaries) {
+    Universe universe;
+    makeScene(universe);
+    universe.setPublishInterval(1000);
+    StepLog log;
+    universe.addObserver(&log);
+    ThreadPool pool(4);
+
+    Parareal parareal(60, 6 * 3600, 0.0, 4);
+    EXPECT_THROW(parareal.integrate(universe, 86400, 0, pool), std::invalid_argument);
+    EXPECT_TRUE(log.steps.empty());
+
+    parareal.integrate(universe, 4 * 86400, 4, pool);
+    ASSERT_EQ(log.steps.size(), 4u);
+    for (size_t n = 0; n < 4; ++n) {
+        EXPECT_EQ(log.steps[n], 1440 * (n + 1));
+        EXPECT_DOUBLE_EQ(log.times[n], 86400.0 * (n + 1));
+    }
+
+    // The boundary at step 5760 is the last that passed a multiple of 1000.
+    ASSERT_NE(universe.getState(), nullptr);
+    EXPECT_EQ(universe.getState()->step, 5760u);
+    universe.removeObserver(&log);
+}
+
+TEST_F(PararealTest, RejectsInvalidSteps) {
+    Universe universe;
+    makeScene(universe);
+    ThreadPool pool(2);
+
+    const double steps[] = {0, -60, std::numeric_limits<double>::quiet_NaN(),
+                            std::numeric_limits<double>::infinity()};
+    for (double step : steps) {
+        EXPECT_THROW(Parareal(step, 3600, 0.0, 4).integrate(universe, 86400, 2, pool), std::invalid_argument);
+        EXPECT_THROW(Parareal(60, step, 0.0, 4).integrate(universe, 86400, 2, pool), std::invalid_argument);
+    }
+    EXPECT_EQ(universe.getStepCount(), 0u);
+}
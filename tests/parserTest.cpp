@@ -0,0 +1,233 @@
+/*
+ * Edward Goode @2016
+ */
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "../include/Object.h"
+#include "../include/Parser.h"
+#include "../include/ThreadPool.h"
+#include "../include/Universe.h"
+#include "./testHelper.h"
+
+// The fixture for testing class Parser.
+class ParserTest : public ::testing::Test {};
+
+namespace {
+void load(Universe &universe, const std::string &text) {
+    Parser parser(universe);
+    parser.loadText(text.data(), text.data() + text.size());
+}
+}
+
+TEST_F(ParserTest, LoadFile) {
+    Universe universe;
+    Parser parser(universe);
+    parser.loadFile("../tests/UCMtest.txt");
+    ASSERT_EQ(std::distance(universe.begin(), universe.end()), 2);
+
+    const Object &sun = **universe.begin();
+    const Object &earth = **(++universe.begin());
+    EXPECT_EQ(sun.getName(), "sun");
+    EXPECT_EQ(sun.getMass(), 1.98892e30);
+    EXPECT_EQ(sun.getPosition(), makeVector2());
+    EXPECT_EQ(earth.getName(), "earth");
+    EXPECT_EQ(earth.getMass(), 5.9742e24);
+    EXPECT_EQ(earth.getPosition(), makeVector2(149597870700, 0));
+    EXPECT_EQ(earth.getVelocity(), makeVector2(0, 29788.4676));
+
+    EXPECT_THROW(parser.loadFile("../tests/missing.txt"), std::runtime_error);
+}
+
+TEST_F(ParserTest, Syntax) {
+    Universe universe;
+    load(universe, "\n{a,1,[2 3],[4 5]}\r\n\t{ b , -1.5e-3 ,[ .5, 6. ], [+7e+2 0]}  \n\n"
+                   "c 2 0 0 0 0");
+    ASSERT_EQ(std::distance(universe.begin(), universe.end()), 3);
+
+    Universe::const_iterator i = universe.begin();
+    EXPECT_EQ((*i)->getName(), "a");
+    EXPECT_EQ((*i)->getVelocity(), makeVector2(4, 5));
+    ++i;
+    EXPECT_EQ((*i)->getName(), "b");
+    EXPECT_EQ((*i)->getMass(), -1.5e-3);
+    EXPECT_EQ((*i)->getPosition(), makeVector2(0.5, 6));
+    EXPECT_EQ((*i)->getVelocity(), makeVector2(700, 0));
+    ++i;
+    EXPECT_EQ((*i)->getName(), "c");
+}
+
+TEST_F(ParserTest, Errors) {
+    const char *scripts[] = {
+        "{sun, 1, [0 0], [0 0]}\n{earth, 1, [0 0], [0]}",
+        "{sun, 1, [0 0], [0 0], 4}",
+        "{sun, 1x, [0 0], [0 0]}",
+        "{sun, 1e, [0 0], [0 0]}",
+        "{sun, --1, [0 0], [0 0]}",
+        "{sun, 1.2.3, [0 0], [0 0]}"
+    };
+
+    for (const char *script : scripts) {
+        Universe universe;
+        EXPECT_THROW(load(universe, script), std::runtime_error) << script;
+        // Nothing is registered from a malformed script.
+        EXPECT_EQ(universe.begin(), universe.end()) << script;
+    }
+
+    Universe universe;
+    try {
+        load(universe, "{sun, 1, [0 0], [0 0]}\n\n{earth, x, [0 0], [0 0]}");
+        FAIL();
+    } catch (const std::runtime_error &error) {
+        EXPECT_EQ(std::string(error.what()).find("line 3"), 0u) << error.what();
+    }
+}
+
+TEST_F(ParserTest, NumbersMatchStrtod) {
+    // Exercises the fast path as well as the fallback for long significands
+    // and extreme exponents.
+    std::mt19937_64 random(42);
+    std::uniform_int_distribution<int> exponents(-330, 310);
+    std::uniform_int_distribution<int> formats(0, 3);
+    const char *patterns[] = {"%.17g", "%.6g", "%.3f", "%.25e"};
+
+    std::string script;
+    std::vector<std::string> numbers;
+    for (int i = 0; i < 2000; ++i) {
+        double value = std::ldexp(double(random() >> 11), exponents(random) - 53);
+        char text[512];
+        std::snprintf(text, sizeof(text), patterns[formats(random)], value);
+        numbers.push_back(text);
+        script += "{n, " + numbers.back() + ", [1 2], [3 4]}\n";
+    }
+    // Exact integers with a large decimal exponent.
+    const char *extra[] = {"1.98892e30", "123456789e30", "9007199254740993", "1e23",
+                           "0.000000000000000000000000000001", "123456789012345678901234567890"};
+    for (const char *text : extra) {
+        numbers.push_back(text);
+        script += std::string("{n, ") + text + ", [1 2], [3 4]}\n";
+    }
+
+    Universe universe;
+    load(universe, script);
+    ASSERT_EQ(size_t(std::distance(universe.begin(), universe.end())), numbers.size());
+
+    Universe::const_iterator object = universe.begin();
+    for (const std::string &text : numbers)
+        EXPECT_EQ((*object++)->getMass(), std::strtod(text.c_str(), nullptr)) << text;
+}
+
+TEST_F(ParserTest, ParallelMatchesSequential) {
+    // Large enough to be split into many chunks, with lines of varying
+    // length and a final line without a newline.
+    std::string script = "{sun, 1.98892e30, [0 0], [0 0]}\n";
+    for (int i = 0; i < 40000; ++i)
+        script += "{body" + std::to_string(i) + ", " + std::to_string(i * 1e9) + ", ["
+                  + std::to_string(i) + " -" + std::to_string(i / 3.0) + "], [0.5 "
+                  + std::to_string(i % 7) + "]}" + (i % 5 ? "\n" : "\n\n");
+    script += "{last, 1, [2 3], [4 5]}";
+
+    Universe sequential;
+    load(sequential, script);
+
+    ThreadPool pool(4);
+    Universe parallel;
+    Parser parser(parallel);
+    parser.loadText(script.data(), script.data() + script.size(), pool);
+
+    ASSERT_EQ(std::distance(parallel.begin(), parallel.end()),
+              std::distance(sequential.begin(), sequential.end()));
+    for (Universe::const_iterator i = sequential.begin(), j = parallel.begin();
+         i != sequential.end(); ++i, ++j) {
+        EXPECT_EQ((*i)->getName(), (*j)->getName());
+        EXPECT_EQ((*i)->getMass(), (*j)->getMass());
+        EXPECT_EQ((*i)->getPosition(), (*j)->getPosition());
+        EXPECT_EQ((*i)->getVelocity(), (*j)->getVelocity());
+    }
+
+    // Small scripts are parsed in place.
+    parser.loadFile("../tests/UCMtest.txt", pool);
+    EXPECT_EQ((*(parallel.end() - 1))->getName(), "earth");
+}
+
+TEST_F(ParserTest, ParallelErrors) {
+    std::string script;
+    for (int i = 0; i < 30000; ++i)
+        script += "{body, 1, [2 3], [4 5]}\n";
+    script += "{body, 1, [2 3], [4]}\n";
+    script += "{body, 1, [2 3]}\n";
+
+    ThreadPool pool(4);
+    Universe universe;
+    Parser parser(universe);
+    try {
+        parser.loadText(script.data(), script.data() + script.size(), pool);
+        FAIL();
+    } catch (const std::runtime_error &error) {
+        // The first malformed line is reported, numbered from the start.
+        EXPECT_EQ(std::string(error.what()).find("line 30001:"), 0u) << error.what();
+    }
+    EXPECT_EQ(universe.begin(), universe.end());
+}
+
+TEST_F(ParserTest, Stream) {
+    const char *path = "parserStreamTest.txt";
+    std::string script;
+    {
+        std::ofstream file(path, std::ios::binary);
+        for (int i = 0; i < 1000; ++i)
+            script += "{body" + std::to_string(i) + ", " + std::to_string(i) + ", [1 2], [3 4]}\n";
+        // A line longer than the block and no final newline.
+        script += "{" + std::string(300, 'x') + ", 1, [2 3], [4 5]}";
+        file << script;
+    }
+
+    Universe universe;
+    Parser parser(universe);
+    size_t calls = 0, lastBodies = 0, lastBytes = 0;
+    parser.streamFile(path, [&](size_t bodies, size_t bytes) {
+        // The bodies read so far are already usable.
+        EXPECT_EQ(size_t(std::distance(universe.begin(), universe.end())), bodies);
+        EXPECT_GE(bodies, lastBodies);
+        EXPECT_GE(bytes, lastBytes);
+        lastBodies = bodies;
+        lastBytes = bytes;
+        calls++;
+    }, 256);
+
+    EXPECT_GT(calls, 100u);
+    EXPECT_EQ(lastBodies, 1001u);
+    EXPECT_EQ(lastBytes, script.size());
+    ASSERT_EQ(std::distance(universe.begin(), universe.end()), 1001);
+    EXPECT_EQ((*universe.begin())->getName(), "body0");
+    EXPECT_EQ((*(universe.begin() + 999))->getMass(), 999);
+    EXPECT_EQ((*(universe.end() - 1))->getName(), std::string(300, 'x'));
+
+    // Bodies of the blocks before a malformed line stay registered.
+    {
+        std::ofstream file(path, std::ios::binary);
+        for (int i = 0; i < 100; ++i)
+            file << "{body, 1, [2 3], [4 5]}\n";
+        file << "{body, 1, [2 3], [4 y]}\n";
+    }
+    Universe partial;
+    Parser partialParser(partial);
+    try {
+        partialParser.streamFile(path, Parser::Progress(), 128);
+        FAIL();
+    } catch (const std::runtime_error &error) {
+        EXPECT_NE(std::string(error.what()).find("line 101:"), std::string::npos) << error.what();
+    }
+    EXPECT_GT(std::distance(partial.begin(), partial.end()), 90);
+    EXPECT_LE(std::distance(partial.begin(), partial.end()), 100);
+
+    std::remove(path);
+    EXPECT_THROW(parser.streamFile(path), std::runtime_error);
+}
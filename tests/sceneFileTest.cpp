@@ -0,0 +1,104 @@
+/*
+ * Edward Goode @2016
+ */
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <gtest/gtest.h>
+#include "../include/Object.h"
+#include "../include/ObjectFactory.h"
+#include "../include/Parser.h"
+#include "../include/SceneFile.h"
+#include "../include/Universe.h"
+#include "./testHelper.h"
+
+// The fixture for testing class SceneFile.
+class SceneFileTest : public ::testing::Test {};
+
+namespace {
+const char *path = "sceneFileTest.scene";
+
+std::string readFile(const char *name) {
+    std::ifstream file(name, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+void writeFile(const char *name, const std::string &contents) {
+    std::ofstream file(name, std::ios::binary);
+    file << contents;
+}
+}
+
+TEST_F(SceneFileTest, RoundTrip) {
+    Universe original;
+    Parser(original).loadFile("../tests/UCMtest.txt");
+    original.addObject(ObjectFactory::makeObject("", 0.1, makeVector2(-0.0, 1e-300),
+                                                 makeVector2(1.0 / 3, -7)));
+    SceneFile::write(path, original);
+    EXPECT_TRUE(SceneFile::isSceneFile(path));
+    EXPECT_FALSE(SceneFile::isSceneFile("../tests/UCMtest.txt"));
+
+    SceneFile scene(path);
+    ASSERT_EQ(scene.size(), 3u);
+    EXPECT_EQ(scene.getName(0), "sun");
+    EXPECT_EQ(scene.getName(1), "earth");
+    EXPECT_EQ(scene.getName(2), "");
+    // The columns are used in place.
+    EXPECT_EQ(scene.masses()[1], 5.9742e24);
+    EXPECT_EQ(scene.positions(0)[1], 149597870700.0);
+    EXPECT_EQ(scene.velocities(1)[1], 29788.4676);
+    EXPECT_EQ(scene.velocities(0)[2], 1.0 / 3);
+
+    Universe loaded;
+    scene.addTo(loaded);
+    ASSERT_EQ(std::distance(loaded.begin(), loaded.end()), 3);
+    for (Universe::const_iterator i = original.begin(), j = loaded.begin(); i != original.end(); ++i, ++j) {
+        EXPECT_EQ((*i)->getName(), (*j)->getName());
+        EXPECT_EQ((*i)->getMass(), (*j)->getMass());
+        EXPECT_EQ((*i)->getPosition(), (*j)->getPosition());
+        EXPECT_EQ((*i)->getVelocity(), (*j)->getVelocity());
+    }
+
+    Universe empty;
+    SceneFile::write(path, empty);
+    EXPECT_EQ(SceneFile(path).size(), 0u);
+    std::remove(path);
+}
+
+TEST_F(SceneFileTest, RejectsInvalidFiles) {
+    Universe universe;
+    Parser(universe).loadFile("../tests/UCMtest.txt");
+    SceneFile::write(path, universe);
+    const std::string contents = readFile(path);
+
+    EXPECT_THROW(SceneFile("../tests/UCMtest.txt"), std::runtime_error);
+    EXPECT_THROW(SceneFile("../tests/missing.scene"), std::runtime_error);
+
+    // Truncated.
+    writeFile(path, contents.substr(0, contents.size() - 1));
+    EXPECT_THROW(SceneFile scene(path), std::runtime_error);
+
+    // Unknown version; the version follows the magic and byte order mark.
+    std::string modified = contents;
+    modified[12] = 99;
+    writeFile(path, modified);
+    EXPECT_THROW(SceneFile scene(path), std::runtime_error);
+
+    // Foreign byte order.
+    modified = contents;
+    std::swap(modified[8], modified[11]);
+    writeFile(path, modified);
+    EXPECT_THROW(SceneFile scene(path), std::runtime_error);
+
+    // Huge body count.
+    modified = contents;
+    modified[23] = 0x40;
+    writeFile(path, modified);
+    EXPECT_THROW(SceneFile scene(path), std::runtime_error);
+
+    writeFile(path, contents);
+    EXPECT_NO_THROW(SceneFile scene(path));
+    std::remove(path);
+}
@@ -0,0 +1,135 @@
+/*
+ * Edward Goode @2016
+ */
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include <gtest/gtest.h>
+#include "../include/TrajectoryCodec.h"
+
+// The fixture for testing the trajectory codec.
+class TrajectoryCodecTest : public ::testing::Test {};
+
+namespace {
+/**
+ *  Encodes values, decodes them again and expects the same bit patterns.
+ *  Returns the size of the stream.
+ */
+size_t roundTrip(const std::vector<double> &values) {
+    std::vector<char> stream(3, 'x');
+    TrajectoryCodec::encode(values.data(), values.size(), stream);
+
+    std::vector<double> decoded(values.size());
+    const char *end = TrajectoryCodec::decode(stream.data() + 3, stream.data() + stream.size(),
+                                              decoded.size(), decoded.data());
+    EXPECT_EQ(end, stream.data() + stream.size());
+    EXPECT_EQ(std::memcmp(decoded.data(), values.data(), values.size() * sizeof(double)), 0);
+    return stream.size() - 3;
+}
+}
+
+TEST_F(TrajectoryCodecTest, RoundTrip) {
+    const double inf = std::numeric_limits<double>::infinity();
+    std::vector<double> special = {0.0, -0.0, inf, -inf, std::numeric_limits<double>::quiet_NaN(),
+                                   std::numeric_limits<double>::denorm_min(),
+                                   std::numeric_limits<double>::max(), -1.5, 1e300, 2.5e-310};
+    for (size_t count = 0; count <= special.size(); ++count)
+        roundTrip(std::vector<double>(special.begin(), special.begin() + count));
+
+    std::mt19937_64 random(42);
+    std::vector<double> noise(1001);
+    for (double &value : noise) {
+        const uint64_t bits = random();
+        std::memcpy(&value, &bits, sizeof(value));
+    }
+    // Incompressible data costs at most half a byte more per value.
+    EXPECT_LE(roundTrip(noise), 1 + noise.size() * 8 + (noise.size() + 1) / 2);
+
+    std::vector<uint64_t> steps;
+    for (uint64_t step = 0; step < 1000; step += 10)
+        steps.push_back(step);
+    std::vector<char> stream;
+    TrajectoryCodec::encode(steps.data(), steps.size(), stream);
+    // Every step after the second is predicted exactly.
+    EXPECT_LE(stream.size(), 4 + steps.size() / 2);
+    std::vector<uint64_t> decoded(steps.size());
+    TrajectoryCodec::decode(stream.data(), stream.data() + stream.size(), decoded.size(), decoded.data());
+    EXPECT_EQ(decoded, steps);
+}
+
+TEST_F(TrajectoryCodecTest, CompressesSmoothColumns) {
+    // A circular orbit crossing zero and several binades.
+    std::vector<double> x, vx;
+    for (int i = 0; i < 4096; ++i) {
+        const double angle = 2e-3 * i;
+        x.push_back(1.495978707e11 * std::cos(angle));
+        vx.push_back(-29788.4676 * std::sin(angle));
+    }
+    EXPECT_LT(3 * roundTrip(x), x.size() * sizeof(double));
+    EXPECT_LT(3 * roundTrip(vx), vx.size() * sizeof(double));
+}
+
+TEST_F(TrajectoryCodecTest, Chunks) {
+    const size_t count = 7, columns = 3;
+    std::vector<uint64_t> steps;
+    std::vector<double> times, values;
+    for (size_t i = 0; i < count; ++i) {
+        steps.push_back(5 * i);
+        times.push_back(0.1 * i);
+    }
+    for (size_t i = 0; i < count * columns; ++i)
+        values.push_back(std::sqrt(double(i)));
+
+    std::vector<char> payload;
+    TrajectoryCodec::encodeChunk(count, columns, steps.data(), times.data(), values.data(), payload);
+    EXPECT_EQ(payload.size() % 8, 0u);
+
+    std::vector<uint64_t> decodedSteps(count);
+    std::vector<double> decodedTimes(count), decodedValues(count * columns);
+    TrajectoryCodec::decodeChunk(payload.data(), payload.size(), count, columns, decodedSteps.data(),
+                                 decodedTimes.data(), decodedValues.data());
+    EXPECT_EQ(decodedSteps, steps);
+    EXPECT_EQ(decodedTimes, times);
+    EXPECT_EQ(decodedValues, values);
+
+    std::vector<double> column(count);
+    TrajectoryCodec::decodeStream(payload.data(), payload.size(), count, columns, 3, column.data());
+    EXPECT_EQ(column, std::vector<double>(values.begin() + count, values.begin() + 2 * count));
+    EXPECT_THROW(TrajectoryCodec::decodeStream(payload.data(), payload.size(), count, columns, 5,
+                                               column.data()), std::invalid_argument);
+}
+
+TEST_F(TrajectoryCodecTest, Errors) {
+    std::vector<double> values = {1.0, 2.0, 3.5, -7.25, 1e10};
+    std::vector<char> stream;
+    TrajectoryCodec::encode(values.data(), values.size(), stream);
+    std::vector<double> decoded(values.size() + 2);
+    const char *begin = stream.data();
+    const char *end = begin + stream.size();
+
+    EXPECT_THROW(TrajectoryCodec::decode(begin, begin, 1, decoded.data()), std::runtime_error);
+    EXPECT_THROW(TrajectoryCodec::decode(begin, end - 1, values.size(), decoded.data()), std::runtime_error);
+    EXPECT_THROW(TrajectoryCodec::decode(begin, end, values.size() + 2, decoded.data()), std::runtime_error);
+
+    std::vector<char> corrupt(stream);
+    corrupt[0] = 9;
+    EXPECT_THROW(TrajectoryCodec::decode(corrupt.data(), corrupt.data() + corrupt.size(), values.size(),
+                                         decoded.data()), std::runtime_error);
+    corrupt = stream;
+    corrupt[1] = char(0xff);
+    EXPECT_THROW(TrajectoryCodec::decode(corrupt.data(), corrupt.data() + corrupt.size(), values.size(),
+                                         decoded.data()), std::runtime_error);
+
+    std::vector<char> payload;
+    const uint64_t steps[2] = {0, 1};
+    TrajectoryCodec::encodeChunk(2, 1, steps, values.data(), values.data(), payload);
+    std::vector<uint64_t> decodedSteps(2);
+    EXPECT_THROW(TrajectoryCodec::decodeStream(payload.data(), 16, 2, 1, 0, decodedSteps.data()),
+                 std::runtime_error);
+    EXPECT_THROW(TrajectoryCodec::decodeStream(payload.data(), payload.size(), 1, 1, 0, decodedSteps.data()),
+                 std::runtime_error);
+}
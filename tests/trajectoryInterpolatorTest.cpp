@@ -0,0 +1,126 @@
+/*
+ * Edward Goode @2016
+ */
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include <gtest/gtest.h>
+#include "../include/Object.h"
+#include "../include/ObjectFactory.h"
+#include "../include/TrajectoryInterpolator.h"
+#include "../include/TrajectoryReader.h"
+#include "../include/TrajectoryRecorder.h"
+#include "../include/Universe.h"
+#include "./testHelper.h"
+
+// The fixture for testing the trajectory interpolator.
+class TrajectoryInterpolatorTest : public ::testing::Test {};
+
+namespace {
+const char *path = "trajectoryInterpolatorTest.traj";
+const double radius = 149597870700.0;
+const double omega = 29788.4676 / radius;
+
+vector2 position(double time) {
+    return makeVector2(radius * std::cos(omega * time), radius * std::sin(omega * time));
+}
+
+vector2 velocity(double time) {
+    return makeVector2(-radius * omega * std::sin(omega * time), radius * omega * std::cos(omega * time));
+}
+
+/**
+ *  Records count samples, interval seconds apart, of the sun and of a planet
+ *  on an exact circular orbit.
+ */
+void recordOrbit(double interval, size_t count) {
+    Universe universe;
+    universe.addObject(ObjectFactory::makeObject("sun", 1.98892e30));
+    universe.addObject(ObjectFactory::makeObject("planet", 5.9742e24, position(0), velocity(0)));
+
+    // Samples are taken by hand after the state is replaced.
+    TrajectoryRecorder recorder(universe, path, size_t(1) << 40);
+    for (size_t i = 0; i < count; ++i) {
+        if (i > 0)
+            universe.stepSimulation(interval);
+        // Stepping replaces the objects of the Universe.
+        Object *planet = *(universe.begin() + 1);
+        planet->setPosition(position(universe.getTime()));
+        planet->setVelocity(velocity(universe.getTime()));
+        recorder.record(universe);
+    }
+    recorder.close();
+}
+}
+
+TEST_F(TrajectoryInterpolatorTest, Accuracy) {
+    // Ten days between samples, so linear interpolation would be off by
+    // about 5e8 m.
+    const double interval = 864000;
+    recordOrbit(interval, 40);
+    TrajectoryReader reader(path);
+    TrajectoryInterpolator interpolator(reader);
+    std::vector<TrajectoryInterpolator::State> states;
+    const std::vector<size_t> bodies = {1, 0};
+
+    double largest = 0;
+    for (int i = 0; i <= 39 * 16; ++i) {
+        const double time = i * interval / 16;
+        interpolator.interpolate(time, bodies, states);
+        ASSERT_EQ(states.size(), 2u);
+        const double error = (states[0].position - position(time)).norm();
+        largest = std::max(largest, error);
+        EXPECT_LE(error, 1.5 * states[0].error + 1e-3);
+        EXPECT_LE(states[0].error, 1e6);
+        EXPECT_LT((states[0].velocity - velocity(time)).norm(), 1e-3 * 29788.4676);
+        EXPECT_EQ(states[1].position.norm(), 0.0);
+
+        if (i % 16 == 0) {
+            EXPECT_EQ(states[0].error, 0.0);
+            EXPECT_EQ(states[0].position[0], position(time)[0]);
+            EXPECT_EQ(states[0].velocity[1], velocity(time)[1]);
+        }
+    }
+    EXPECT_GT(largest, 1e4);
+    EXPECT_LT(largest, 1e6);
+
+    // Going back in time reloads the samples.
+    interpolator.interpolate(0.5 * interval, bodies, states);
+    EXPECT_LT((states[0].position - position(0.5 * interval)).norm(), 1e6);
+    std::remove(path);
+}
+
+TEST_F(TrajectoryInterpolatorTest, FewSamples) {
+    std::vector<TrajectoryInterpolator::State> states;
+    const std::vector<size_t> bodies = {1};
+
+    recordOrbit(3600, 2);
+    {
+        TrajectoryReader reader(path);
+        TrajectoryInterpolator interpolator(reader);
+        interpolator.interpolate(1800, bodies, states);
+        EXPECT_LT((states[0].position - position(1800)).norm(), 1.0);
+        // Without a neighbouring interval nothing is known about the error.
+        EXPECT_EQ(states[0].error, std::numeric_limits<double>::infinity());
+        interpolator.interpolate(3600, bodies, states);
+        EXPECT_EQ(states[0].error, 0.0);
+        EXPECT_THROW(interpolator.interpolate(3601, bodies, states), std::invalid_argument);
+        EXPECT_THROW(interpolator.interpolate(-1, bodies, states), std::invalid_argument);
+        EXPECT_THROW(interpolator.interpolate(std::nan(""), bodies, states), std::invalid_argument);
+        EXPECT_THROW(interpolator.interpolate(1800, std::vector<size_t>(1, 2), states),
+                     std::invalid_argument);
+    }
+
+    recordOrbit(3600, 1);
+    {
+        TrajectoryReader reader(path);
+        TrajectoryInterpolator interpolator(reader);
+        interpolator.interpolate(0, bodies, states);
+        EXPECT_EQ(states[0].position[0], radius);
+        EXPECT_EQ(states[0].error, 0.0);
+        EXPECT_THROW(interpolator.interpolate(1, bodies, states), std::invalid_argument);
+    }
+    std::remove(path);
+}
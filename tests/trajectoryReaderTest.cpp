@@ -0,0 +1,240 @@
+/*
+ * Edward Goode @2016
+ */
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "../include/Object.h"
+#include "../include/ObjectFactory.h"
+#include "../include/TrajectoryReader.h"
+#include "../include/TrajectoryRecorder.h"
+#include "../include/Universe.h"
+#include "./testHelper.h"
+
+// The fixture for testing the trajectory reader.
+class TrajectoryReaderTest : public ::testing::Test {};
+
+namespace {
+const char *path = "trajectoryReaderTest.traj";
+
+/**
+ *  The recorded state of every body, sample-major as in a Window.
+ */
+struct Recording {
+    std::vector<uint64_t> steps;
+    std::vector<double> times;
+    std::vector<double> values;
+};
+
+/**
+ *  Records 50 samples of three bodies in chunks of 8 samples to path and
+ *  returns what was recorded.
+ */
+Recording record(TrajectoryRecorder::Encoding encoding) {
+    Universe universe;
+    universe.addObject(ObjectFactory::makeObject("sun", 1.98892e30));
+    universe.addObject(ObjectFactory::makeObject("earth", 5.9742e24, makeVector2(149597870700.0, 0),
+                                                 makeVector2(0, 29788.4676)));
+    universe.addObject(ObjectFactory::makeObject("mars", 6.4171e23, makeVector2(0, -227939200000.0),
+                                                 makeVector2(24077, 0)));
+
+    Recording recording;
+    const size_t sampleBytes = (TrajectoryRecorder::quantities * 3 + 2) * sizeof(double);
+    TrajectoryRecorder recorder(universe, path, 2, 8, 8 * sampleBytes, encoding);
+    for (int step = 1; step <= 100; ++step) {
+        universe.stepSimulation(3600);
+        if (step % 2 != 0)
+            continue;
+        recording.steps.push_back(universe.getStepCount());
+        recording.times.push_back(universe.getTime());
+        for (Universe::const_iterator i = universe.begin(); i != universe.end(); ++i) {
+            recording.values.push_back((*i)->getPosition()[0]);
+            recording.values.push_back((*i)->getPosition()[1]);
+            recording.values.push_back((*i)->getVelocity()[0]);
+            recording.values.push_back((*i)->getVelocity()[1]);
+        }
+    }
+    recorder.close();
+    return recording;
+}
+
+/**
+ *  Expects that reader reads back recording for some windows and bodies.
+ */
+void expectRecording(const TrajectoryReader &reader, const Recording &recording) {
+    ASSERT_EQ(reader.getBodyCount(), 3u);
+    EXPECT_EQ(reader.getName(1), "earth");
+    EXPECT_EQ(reader.findBody("mars"), 2u);
+    ASSERT_EQ(reader.getSampleCount(), 50u);
+    EXPECT_EQ(reader.getChunkCount(), 7u);
+    EXPECT_EQ(reader.getInterval(), 2u);
+
+    for (size_t sample = 0; sample < 50; ++sample) {
+        EXPECT_EQ(reader.getStep(sample), recording.steps[sample]);
+        EXPECT_EQ(reader.getTime(sample), recording.times[sample]);
+        EXPECT_EQ(reader.findSample(recording.times[sample]), sample);
+        EXPECT_EQ(reader.findSample(recording.times[sample] - 1), sample);
+    }
+    EXPECT_EQ(reader.findSample(recording.times.back() + 1), 50u);
+
+    // Windows within one chunk, across chunks, and of every sample.
+    const size_t windows[][2] = {{3, 4}, {6, 20}, {0, 50}, {49, 1}, {10, 0}};
+    const std::vector<size_t> bodies = {2, 0};
+    TrajectoryReader::Window window;
+    for (const size_t *w : windows) {
+        reader.read(w[0], w[1], bodies, window);
+        ASSERT_EQ(window.size(), w[1]);
+        EXPECT_EQ(window.first, w[0]);
+        EXPECT_EQ(window.bodies, bodies);
+        for (size_t s = 0; s < w[1]; ++s) {
+            EXPECT_EQ(window.steps[s], recording.steps[w[0] + s]);
+            EXPECT_EQ(window.times[s], recording.times[w[0] + s]);
+            for (size_t b = 0; b < bodies.size(); ++b)
+                for (size_t q = 0; q < TrajectoryRecorder::quantities; ++q)
+                    EXPECT_EQ(window.values[(s * bodies.size() + b) * 4 + q],
+                              recording.values[((w[0] + s) * 3 + bodies[b]) * 4 + q]);
+        }
+    }
+}
+
+/**
+ *  Returns the contents of name.
+ */
+std::string readFile(const char *name) {
+    std::ifstream file(name, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+void writeFile(const char *name, const std::string &data) {
+    std::ofstream(name, std::ios::binary) << data;
+}
+}
+
+TEST_F(TrajectoryReaderTest, Windows) {
+    const TrajectoryRecorder::Encoding encodings[] = {TrajectoryRecorder::raw, TrajectoryRecorder::predictive};
+    for (TrajectoryRecorder::Encoding encoding : encodings) {
+        const Recording recording = record(encoding);
+        {
+            TrajectoryReader reader(path);
+            EXPECT_TRUE(reader.isIndexed());
+            expectRecording(reader, recording);
+        }
+
+        // Without the index the chunks are found by their headers.
+        const std::string data = readFile(path);
+        const size_t indexSize = 7 * sizeof(TrajectoryRecorder::IndexEntry)
+                                 + sizeof(TrajectoryRecorder::IndexTrailer);
+        writeFile(path, data.substr(0, data.size() - indexSize));
+        TrajectoryReader reader(path);
+        EXPECT_FALSE(reader.isIndexed());
+        expectRecording(reader, recording);
+    }
+    std::remove(path);
+}
+
+TEST_F(TrajectoryReaderTest, EmptyRecording) {
+    Universe universe;
+    universe.addObject(ObjectFactory::makeObject("sun", 1.98892e30));
+    TrajectoryRecorder(universe, path).close();
+
+    TrajectoryReader reader(path);
+    EXPECT_EQ(reader.getBodyCount(), 1u);
+    EXPECT_EQ(reader.getSampleCount(), 0u);
+    EXPECT_EQ(reader.findSample(0), 0u);
+    TrajectoryReader::Window window;
+    reader.read(0, 0, std::vector<size_t>(), window);
+    EXPECT_EQ(window.size(), 0u);
+    std::remove(path);
+}
+
+TEST_F(TrajectoryReaderTest, Truncated) {
+    // A recording cut short while writing its last chunk keeps the others.
+    const Recording recording = record(TrajectoryRecorder::raw);
+    const std::string data = readFile(path);
+    const size_t indexSize = 7 * sizeof(TrajectoryRecorder::IndexEntry)
+                             + sizeof(TrajectoryRecorder::IndexTrailer);
+    writeFile(path, data.substr(0, data.size() - indexSize - 100));
+    {
+        TrajectoryReader reader(path);
+        EXPECT_FALSE(reader.isIndexed());
+        EXPECT_EQ(reader.getChunkCount(), 6u);
+        ASSERT_EQ(reader.getSampleCount(), 48u);
+        TrajectoryReader::Window window;
+        reader.read(0, 48, std::vector<size_t>(1, 1), window);
+        for (size_t s = 0; s < 48; ++s) {
+            EXPECT_EQ(window.steps[s], recording.steps[s]);
+            for (size_t q = 0; q < TrajectoryRecorder::quantities; ++q)
+                EXPECT_EQ(window.values[s * 4 + q], recording.values[(s * 3 + 1) * 4 + q]);
+        }
+    }
+
+    // Cut short while writing the index, which leaves every chunk intact.
+    for (size_t written : {size_t(1), size_t(3 * sizeof(TrajectoryRecorder::IndexEntry) + 5), indexSize - 1}) {
+        writeFile(path, data.substr(0, data.size() - indexSize + written));
+        TrajectoryReader reader(path);
+        EXPECT_FALSE(reader.isIndexed());
+        EXPECT_EQ(reader.getChunkCount(), 7u);
+        EXPECT_EQ(reader.getSampleCount(), 50u);
+        EXPECT_EQ(reader.getTime(49), recording.times[49]);
+    }
+
+    // Down to a part of the first chunk header.
+    const size_t firstChunk = data.find("CHNK");
+    writeFile(path, data.substr(0, firstChunk + 4));
+    {
+        TrajectoryReader reader(path);
+        EXPECT_EQ(reader.getChunkCount(), 0u);
+        EXPECT_EQ(reader.getSampleCount(), 0u);
+    }
+    std::remove(path);
+}
+
+TEST_F(TrajectoryReaderTest, Errors) {
+    EXPECT_THROW(TrajectoryReader("missing.traj"), std::runtime_error);
+    EXPECT_THROW(TrajectoryReader("../tests/inertiaTest.txt"), std::runtime_error);
+
+    record(TrajectoryRecorder::predictive);
+    {
+        TrajectoryReader reader(path);
+        TrajectoryReader::Window window;
+        EXPECT_THROW(reader.getName(3), std::invalid_argument);
+        EXPECT_THROW(reader.findBody("pluto"), std::invalid_argument);
+        EXPECT_THROW(reader.getTime(50), std::invalid_argument);
+        EXPECT_THROW(reader.read(45, 6, std::vector<size_t>(1, 0), window), std::invalid_argument);
+        EXPECT_THROW(reader.read(0, 1, std::vector<size_t>(1, 3), window), std::invalid_argument);
+    }
+
+    // Bytes after the chunks that are not the start of their index.
+    const std::string data = readFile(path);
+    const size_t indexStart = data.size() - sizeof(TrajectoryRecorder::IndexTrailer)
+                              - 7 * sizeof(TrajectoryRecorder::IndexEntry);
+    std::string corrupt = data.substr(0, indexStart + 40);
+    corrupt[indexStart] += 8;
+    writeFile(path, corrupt);
+    EXPECT_THROW(TrajectoryReader reader(path), std::runtime_error);
+
+    // An index entry pointing into a chunk.
+    corrupt = data;
+    corrupt[indexStart] += 8;
+    writeFile(path, corrupt);
+    EXPECT_THROW(TrajectoryReader reader(path), std::runtime_error);
+
+    // A corrupt chunk header is only noticed when that chunk is read.
+    TrajectoryRecorder::IndexEntry second;
+    std::memcpy(&second, data.data() + data.size() - sizeof(TrajectoryRecorder::IndexTrailer)
+                - 6 * sizeof(second), sizeof(second));
+    corrupt = data;
+    corrupt[second.offset] = 'X';
+    writeFile(path, corrupt);
+    {
+        TrajectoryReader reader(path);
+        EXPECT_NO_THROW(reader.getTime(0));
+        EXPECT_THROW(reader.getTime(8), std::runtime_error);
+    }
+    std::remove(path);
+}
@@ -0,0 +1,203 @@
+/*
+ * Edward Goode @2016
+ */
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "../include/Object.h"
+#include "../include/ObjectFactory.h"
+#include "../include/TrajectoryCodec.h"
+#include "../include/TrajectoryRecorder.h"
+#include "../include/Universe.h"
+#include "./testHelper.h"
+
+// The fixture for testing the trajectory recorder.
+class TrajectoryTest : public ::testing::Test {};
+
+namespace {
+const char *path = "trajectoryTest.traj";
+
+void makeScene(Universe &universe) {
+    universe.addObject(ObjectFactory::makeObject("sun", 1.98892e30));
+    universe.addObject(ObjectFactory::makeObject("earth", 5.9742e24, makeVector2(149597870700.0, 0),
+                                                 makeVector2(0, 29788.4676)));
+    universe.addObject(ObjectFactory::makeObject("mars", 6.4171e23, makeVector2(0, -227939200000.0),
+                                                 makeVector2(24077, 0)));
+}
+
+/**
+ *  The state of every body at one sample, quantity-major.
+ */
+struct Sample {
+    uint64_t step;
+    double time;
+    std::vector<double> values;
+};
+
+Sample capture(const Universe &universe) {
+    Sample sample = {universe.getStepCount(), universe.getTime(), std::vector<double>()};
+    for (size_t q = 0; q < TrajectoryRecorder::quantities; ++q)
+        for (Universe::const_iterator i = universe.begin(); i != universe.end(); ++i) {
+            const vector2 value = q < 2 ? (*i)->getPosition() : (*i)->getVelocity();
+            sample.values.push_back(value[q % 2]);
+        }
+    return sample;
+}
+
+/**
+ *  Reads every sample of a trajectory file written by the recorder.
+ */
+std::vector<Sample> readSamples(const char *name, std::vector<std::string> &names, size_t &chunks) {
+    std::ifstream file(name, std::ios::binary);
+    const std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    const char *cursor = data.data();
+
+    TrajectoryRecorder::FileHeader header;
+    std::memcpy(&header, cursor, sizeof(header));
+    cursor += sizeof(header);
+    EXPECT_EQ(std::string(header.magic), "NBTRAJ");
+    EXPECT_EQ(header.version, TrajectoryRecorder::version);
+
+    std::vector<uint64_t> offsets(header.bodyCount + 1);
+    std::memcpy(offsets.data(), cursor, offsets.size() * sizeof(uint64_t));
+    cursor += offsets.size() * sizeof(uint64_t);
+    for (size_t body = 0; body < header.bodyCount; ++body)
+        names.push_back(std::string(cursor + offsets[body], cursor + offsets[body + 1]));
+    cursor += header.namesSize + TrajectoryRecorder::padding(header.namesSize);
+
+    TrajectoryRecorder::IndexTrailer trailer;
+    std::memcpy(&trailer, data.data() + data.size() - sizeof(trailer), sizeof(trailer));
+    EXPECT_EQ(std::string(trailer.magic), "NBTRIDX");
+    std::vector<TrajectoryRecorder::IndexEntry> index(trailer.entryCount);
+    const char *indexStart = data.data() + data.size() - sizeof(trailer) - index.size() * sizeof(index[0]);
+    std::memcpy(index.data(), indexStart, index.size() * sizeof(index[0]));
+
+    std::vector<Sample> samples;
+    const size_t columns = TrajectoryRecorder::quantities * header.bodyCount;
+    for (chunks = 0; cursor < indexStart; ++chunks) {
+        EXPECT_EQ(size_t(cursor - data.data()), index[chunks].offset);
+        TrajectoryRecorder::ChunkHeader chunk;
+        std::memcpy(&chunk, cursor, sizeof(chunk));
+        cursor += sizeof(chunk);
+        EXPECT_EQ(std::string(chunk.magic, 4), "CHNK");
+        EXPECT_EQ(chunk.sampleCount, index[chunks].sampleCount);
+        EXPECT_EQ(chunk.size, index[chunks].size);
+
+        const size_t n = chunk.sampleCount;
+        std::vector<double> payload((2 + columns) * n);
+        if (chunk.encoding == TrajectoryRecorder::predictive) {
+            EXPECT_EQ(chunk.size % 8, 0u);
+            TrajectoryCodec::decodeChunk(cursor, chunk.size, n, columns,
+                                         reinterpret_cast<uint64_t *>(payload.data()), &payload[n],
+                                         &payload[2 * n]);
+        } else {
+            EXPECT_EQ(chunk.size, payload.size() * sizeof(double));
+            std::memcpy(payload.data(), cursor, chunk.size);
+        }
+        cursor += chunk.size;
+        for (size_t s = 0; s < n; ++s) {
+            Sample sample;
+            std::memcpy(&sample.step, &payload[s], sizeof(uint64_t));
+            sample.time = payload[n + s];
+            for (size_t k = 0; k < columns; ++k)
+                sample.values.push_back(payload[(2 + k) * n + s]);
+            samples.push_back(sample);
+        }
+        EXPECT_EQ(samples.back().step, index[chunks].lastStep);
+        EXPECT_EQ(samples.back().time, index[chunks].lastTime);
+    }
+    EXPECT_EQ(chunks, index.size());
+    return samples;
+}
+}
+
+TEST_F(TrajectoryTest, RecordsSampledSteps) {
+    Universe universe;
+    makeScene(universe);
+
+    std::vector<Sample> expected;
+    {
+        // Tiny ring and chunks, so the writer falls behind and the last chunk
+        // is partial.
+        const size_t sampleBytes = (TrajectoryRecorder::quantities * 3 + 2) * sizeof(double);
+        TrajectoryRecorder recorder(universe, path, 5, 2, 4 * sampleBytes);
+        recorder.record(universe);
+        expected.push_back(capture(universe));
+        for (int step = 1; step <= 103; ++step) {
+            universe.stepSimulation(3600);
+            if (step % 5 == 0)
+                expected.push_back(capture(universe));
+        }
+        EXPECT_EQ(recorder.getSampleCount(), 21u);
+        recorder.close();
+    }
+    // Closing detached the recorder.
+    universe.stepSimulation(3600);
+
+    std::vector<std::string> names;
+    size_t chunks = 0;
+    std::vector<Sample> samples = readSamples(path, names, chunks);
+    EXPECT_EQ(names, std::vector<std::string>({"sun", "earth", "mars"}));
+    EXPECT_EQ(chunks, 6u);
+    ASSERT_EQ(samples.size(), expected.size());
+    for (size_t i = 0; i < samples.size(); ++i) {
+        EXPECT_EQ(samples[i].step, expected[i].step);
+        EXPECT_EQ(samples[i].time, expected[i].time);
+        EXPECT_EQ(samples[i].values, expected[i].values);
+    }
+    std::remove(path);
+}
+
+TEST_F(TrajectoryTest, CompressedChunks) {
+    const char *rawPath = "trajectoryTestRaw.traj";
+    Universe universe;
+    makeScene(universe);
+
+    std::vector<Sample> expected;
+    {
+        TrajectoryRecorder raw(universe, rawPath);
+        TrajectoryRecorder compressed(universe, path, 1, 8, 1 << 12, TrajectoryRecorder::predictive);
+        for (int step = 0; step < 500; ++step) {
+            universe.stepSimulation(3600);
+            expected.push_back(capture(universe));
+        }
+    }
+
+    std::vector<std::string> names;
+    size_t chunks = 0;
+    std::vector<Sample> samples = readSamples(path, names, chunks);
+    EXPECT_EQ(names, std::vector<std::string>({"sun", "earth", "mars"}));
+    EXPECT_GT(chunks, 1u);
+    ASSERT_EQ(samples.size(), expected.size());
+    for (size_t i = 0; i < samples.size(); ++i) {
+        EXPECT_EQ(samples[i].step, expected[i].step);
+        EXPECT_EQ(samples[i].time, expected[i].time);
+        EXPECT_EQ(samples[i].values, expected[i].values);
+    }
+
+    // Smooth orbits sampled every hour compress well.
+    std::ifstream rawFile(rawPath, std::ios::binary | std::ios::ate);
+    std::ifstream compressedFile(path, std::ios::binary | std::ios::ate);
+    EXPECT_LT(3 * compressedFile.tellg(), rawFile.tellg());
+    std::remove(rawPath);
+    std::remove(path);
+}
+
+TEST_F(TrajectoryTest, Errors) {
+    Universe universe;
+    makeScene(universe);
+    EXPECT_THROW(TrajectoryRecorder(universe, "missing/directory/trajectory.traj"), std::runtime_error);
+
+    TrajectoryRecorder recorder(universe, path);
+    universe.stepSimulation(1);
+    universe.addObject(ObjectFactory::makeObject("comet", 1));
+    EXPECT_THROW(universe.stepSimulation(1), std::invalid_argument);
+    recorder.close();
+    std::remove(path);
+}
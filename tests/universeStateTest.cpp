@@ -0,0 +1,96 @@
+/*
+ * Edward Goode @2016
+ */
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include "../include/Object.h"
+#include "../include/ObjectFactory.h"
+#include "../include/Universe.h"
+#include "./testHelper.h"
+
+
+// The fixture for testing the published UniverseState versions.
+class UniverseStateTest : public ::testing::Test {};
+
+TEST_F(UniverseStateTest, PublishInterval) {
+    std::unique_ptr<Universe> univ(Universe::instance());
+    univ->addObject(ObjectFactory::makeObject("sun", 0));
+    univ->addObject(ObjectFactory::makeObject("obj", 100, makeVector2(100, 100), makeVector2(100, 0)));
+
+    EXPECT_EQ(univ->getState(), nullptr);
+
+    univ->setPublishInterval(5);
+    for (int step = 0; step < 12; ++step)
+        univ->stepSimulation(1);
+
+    std::shared_ptr<const UniverseState> state = univ->getState();
+    ASSERT_NE(state, nullptr);
+    EXPECT_EQ(state->step, 10u);
+    EXPECT_DOUBLE_EQ(state->time, 10);
+    ASSERT_EQ(state->size(), 2u);
+    EXPECT_EQ(state->names[1], "obj");
+    assertVector(state->positions[1], makeVector2(1100, 100));
+
+    // A pinned version is unaffected by later steps and publications.
+    for (int step = 0; step < 8; ++step)
+        univ->stepSimulation(1);
+
+    EXPECT_EQ(state->step, 10u);
+    assertVector(state->positions[1], makeVector2(1100, 100));
+    EXPECT_EQ(univ->getState()->step, 20u);
+    EXPECT_EQ(univ->getStepCount(), 20u);
+}
+
+TEST_F(UniverseStateTest, ConcurrentReaders) {
+    std::unique_ptr<Universe> univ(Universe::instance());
+    univ->addObject(ObjectFactory::makeObject("sun", 0));
+    univ->addObject(ObjectFactory::makeObject("obj", 100, makeVector2(0, 100), makeVector2(1, 0)));
+    univ->setPublishInterval(1);
+    univ->publishState();
+
+    std::atomic<bool> done(false);
+    std::atomic<int> failures(0);
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; ++i) {
+        readers.push_back(std::thread([&]() {
+            size_t last = 0;
+            while (!done) {
+                std::shared_ptr<const UniverseState> state = univ->getState();
+                // Versions only move forward and are internally consistent.
+                if (state->step < last || state->positions[1][0] != state->time)
+                    failures++;
+                last = state->step;
+            }
+        }));
+    }
+
+    for (int step = 0; step < 2000; ++step)
+        univ->stepSimulation(1);
+
+    done = true;
+    for (std::thread &reader : readers)
+        reader.join();
+
+    EXPECT_EQ(failures, 0);
+    EXPECT_EQ(univ->getState()->step, 2000u);
+}
+
+TEST_F(UniverseStateTest, ManyVersions) {
+    std::unique_ptr<Universe> univ(Universe::instance());
+    univ->addObject(ObjectFactory::makeObject("sun", 0));
+    univ->addObject(ObjectFactory::makeObject("obj", 100, makeVector2(0, 100), makeVector2(1, 0)));
+    univ->setPublishInterval(1);
+
+    // Pinned versions outlive the slots they were published through.
+    std::vector<std::shared_ptr<const UniverseState>> pinned;
+    for (int step = 0; step < 50; ++step) {
+        univ->stepSimulation(1);
+        pinned.push_back(univ->getState());
+    }
+    for (size_t i = 0; i < pinned.size(); ++i)
+        EXPECT_EQ(pinned[i]->step, i + 1);
+    EXPECT_EQ(univ->getState(), pinned.back());
+}
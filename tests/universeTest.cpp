@@ -0,0 +1,72 @@
+/*
+ * Edward Goode @2016
+ */
+#include <cmath>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <gtest/gtest.h>
+#include "../include/Object.h"
+#include "../include/ObjectFactory.h"
+#include "../include/Universe.h"
+#include "./testHelper.h"
+
+
+// The fixture for testing independent Universe instances.
+class UniverseTest : public ::testing::Test {};
+
+TEST_F(UniverseTest, IndependentInstances) {
+    std::unique_ptr<Universe> univ(Universe::instance());
+    Universe other;
+    EXPECT_NE(univ.get(), &other);
+
+    univ->addObject(ObjectFactory::makeObject("sun", 0));
+    univ->addObject(ObjectFactory::makeObject("obj", 100, makeVector2(100, 100), makeVector2(100, 0)));
+    other.addObject(ObjectFactory::makeObject("sun", 0));
+    other.addObject(ObjectFactory::makeObject("obj", 100, makeVector2(100, 100), makeVector2(0, 50)));
+
+    for (int step = 0; step < 10; ++step)
+        univ->stepSimulation(1);
+    other.stepSimulation(2);
+
+    assertVector((**(++univ->begin())).getPosition(), makeVector2(1100, 100));
+    assertVector((**(++other.begin())).getPosition(), makeVector2(100, 200));
+    EXPECT_EQ(univ->getStepCount(), 10u);
+    EXPECT_EQ(other.getStepCount(), 1u);
+}
+
+TEST_F(UniverseTest, DestroyingOtherKeepsDefault) {
+    Universe *univ = Universe::instance();
+    {
+        Universe other;
+        other.addObject(ObjectFactory::makeObject("sun", 0));
+    }
+    EXPECT_EQ(Universe::instance(), univ);
+
+    delete univ;
+    EXPECT_EQ(std::distance(Universe::instance()->begin(), Universe::instance()->end()), 0);
+    delete Universe::instance();
+}
+
+TEST_F(UniverseTest, CompensatedSummation) {
+    // One body pulled by a unit mass and by many bodies each too light to
+    // register next to it when the forces are summed naively.
+    const int perturbers = 64;
+    const double light = std::ldexp(1.0, -55);
+    Universe naive, compensated;
+    compensated.setSummation(Summation::compensated);
+    EXPECT_EQ(naive.getSummation(), Summation::naive);
+    EXPECT_EQ(compensated.getSummation(), Summation::compensated);
+
+    for (Universe *univ : {&naive, &compensated}) {
+        univ->addObject(ObjectFactory::makeObject("sun", 1, makeVector2(-1, 0)));
+        univ->addObject(ObjectFactory::makeObject("obj", 1));
+        for (int i = 0; i < perturbers; ++i)
+            univ->addObject(ObjectFactory::makeObject("p" + std::to_string(i), light, makeVector2(-1, 0)));
+        univ->stepSimulation(1);
+    }
+
+    double exact = -Universe::G * (1 + perturbers * light);
+    EXPECT_EQ((**(++naive.begin())).getVelocity()[0], -Universe::G);
+    EXPECT_NEAR((**(++compensated.begin())).getVelocity()[0], exact, Universe::G * 4e-16);
+}
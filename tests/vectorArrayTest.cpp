@@ -0,0 +1,91 @@
+/*
+ * Edward Goode @2016
+ */
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+#include <gtest/gtest.h>
+#include "../include/VectorArray.h"
+
+// The fixture for testing class VectorArray.
+class VectorArrayTest : public ::testing::Test {};
+
+namespace {
+vector3 make3(double x, double y, double z) {
+    const double data[] = {x, y, z};
+    return vector3(data);
+}
+}
+
+TEST_F(VectorArrayTest, ElementAccess) {
+    VectorArray<3> array(2);
+    EXPECT_EQ(array.size(), 2u);
+    EXPECT_EQ(array[1], vector3());
+
+    array.set(1, make3(1, 2, 3));
+    array.push_back(make3(4, 5, 6));
+    EXPECT_EQ(array.size(), 3u);
+    EXPECT_EQ(array[1], make3(1, 2, 3));
+    EXPECT_EQ(array[2], make3(4, 5, 6));
+
+    // Each component is stored contiguously.
+    EXPECT_EQ(array.component(1)[2], 5);
+    array.component(2)[0] = 7;
+    EXPECT_EQ(array[0], make3(0, 0, 7));
+}
+
+TEST_F(VectorArrayTest, BulkOperationsMatchVector) {
+    // Sizes that are not a multiple of the partial sum width.
+    VectorArray<3> a, b;
+    std::vector<vector3> va, vb;
+    std::vector<double> weights;
+    for (int i = 0; i < 11; ++i) {
+        va.push_back(make3(i + 1, 2 * i - 3, 0.5 * i));
+        vb.push_back(make3(3 - i, i * i, 1));
+        a.push_back(va.back());
+        b.push_back(vb.back());
+        weights.push_back(i + 0.25);
+    }
+
+    std::vector<double> dots, norms;
+    a.dot(b, dots);
+    a.norm(norms);
+    vector3 sum, weighted;
+    for (size_t i = 0; i < va.size(); ++i) {
+        EXPECT_DOUBLE_EQ(dots[i], va[i] * vb[i]);
+        EXPECT_DOUBLE_EQ(norms[i], va[i].norm());
+        sum += va[i];
+        weighted += weights[i] * va[i];
+    }
+    EXPECT_EQ(a.sum(), sum);
+    for (size_t d = 0; d < 3; ++d)
+        EXPECT_DOUBLE_EQ(a.sum(weights)[d], weighted[d]);
+
+    VectorArray<3> c(a);
+    c.add(b).scale(2).add(make3(1, 1, 1));
+    c.axpy(-2, b);
+    for (size_t i = 0; i < va.size(); ++i)
+        EXPECT_EQ(c[i], 2 * va[i] + make3(1, 1, 1));
+
+    c = a;
+    c.normalize();
+    for (size_t i = 0; i < va.size(); ++i)
+        for (size_t d = 0; d < 3; ++d)
+            EXPECT_DOUBLE_EQ(c[i][d], vector3(va[i]).normalize()[d]);
+}
+
+TEST_F(VectorArrayTest, Bounds) {
+    VectorArray<2> array;
+    EXPECT_THROW(array.boundingBox(), std::domain_error);
+
+    const double data[] = {1, -4, 3, 2, -2, 0};
+    for (int i = 0; i < 3; ++i)
+        array.push_back(vector2(data + 2 * i));
+    EXPECT_EQ(array.min().toString(), "[-2 -4]");
+    EXPECT_EQ(array.max().toString(), "[3 2]");
+    EXPECT_EQ(array.boundingBox().first, array.min());
+
+    VectorArray<2> shorter(2);
+    EXPECT_THROW(array.add(shorter), std::invalid_argument);
+    EXPECT_THROW(array.sum(std::vector<double>(4)), std::invalid_argument);
+}
@@ -2,7 +2,7 @@
  * G. Hemingway @2016
  */
 #include <cstdlib>          // for std::rand()
-#include <cmath>            // for std::pow()
+#include <cmath>            // for std::pow() and std::ldexp()
 #include <gtest/gtest.h>
 #include "../include/Vector.h"
 
@@ -277,4 +277,227 @@ TEST_F(VectorTest, CrossProduct) {
         // Jacobi identity
         EXPECT_EQ((u ^ (v ^ w)) + (v ^ (w ^ u)) + (w ^ (u ^ v)), zero);
     }
-}
\ No newline at end of file
+}
+
+TEST_F(VectorTest, Expressions) {
+    const vector3 x(data + 1);
+    const vector3 y(data + 4);
+    const vector3 z(data + 7);
+
+    // Chained expressions agree with the named, eagerly evaluated operations.
+    vector3 fused = 2.5 * (x - y) + z / 4.0 - -x;
+    vector3 eager = x.add(y.invert()).scale(2.5).add(z.scale(0.25)).add(x);
+    EXPECT_EQ(fused, eager);
+    EXPECT_EQ((x - y).toString(), "[-3 -3 -3]");
+    EXPECT_DOUBLE_EQ((x - y).normSq(), 27);
+    EXPECT_DOUBLE_EQ((x + y) * (y - x), y.normSq() - x.normSq());
+    EXPECT_EQ((x - y).normalize(), vector3(x - y).normalize());
+
+    // Expression dot products use the same kernels as evaluated vectors.
+    const double values[] = {0.1, 0.7, 1.3, 2.9, 0.3, 1e-3, 0.6, 1.1};
+    const vector2 a(values), b(values + 4);
+    const vector4 c(values), d(values + 4);
+    EXPECT_EQ((a - b).normSq(), vector2(a - b).normSq());
+    EXPECT_EQ((a + b) * (a - b), vector2(a + b) * vector2(a - b));
+    EXPECT_EQ((x / 3.0).normSq(), vector3(x / 3.0).normSq());
+    EXPECT_EQ((c - d).normSq(), vector4(c - d).normSq());
+
+    // Expressions may refer to the vector they are assigned to.
+    vector3 v(x);
+    v = v + v;
+    EXPECT_EQ(v, 2 * x);
+    v = 3 * v - v / 0.5;
+    EXPECT_EQ(v, 2 * x);
+    v += v - x;
+    EXPECT_EQ(v, 3 * x);
+    v -= -v;
+    EXPECT_EQ(v, 6 * x);
+}
+
+template <size_t DIM>
+void testKernels() {
+    Vector<DIM> a = createVector<DIM>();
+    Vector<DIM> b = createVector<DIM>();
+    Vector<DIM> sum, difference, scaled;
+    for (size_t i = 0; i < DIM; ++i) {
+        sum[i] = a[i] + b[i];
+        difference[i] = a[i] - b[i];
+        scaled[i] = a[i] * 1.5;
+    }
+
+    EXPECT_EQ(a.add(b), sum);
+    EXPECT_EQ(a.scale(1.5), scaled);
+    EXPECT_DOUBLE_EQ(a.dot(b), correctDotProduct(a, b));
+    EXPECT_DOUBLE_EQ(a * b, correctDotProduct(a, b));
+
+    Vector<DIM> v(a);
+    EXPECT_EQ(v += b, sum);
+    EXPECT_EQ(v -= b, a);
+    v -= b;
+    EXPECT_EQ(v, difference);
+    EXPECT_EQ(v *= 2, 2 * difference);
+
+    Vector<DIM> fused = a.addScaled(b, 1.5);
+    for (size_t i = 0; i < DIM; ++i)
+        EXPECT_DOUBLE_EQ(fused[i], a[i] + 1.5 * b[i]);
+    v = a;
+    EXPECT_EQ(v.axpy(1.5, b), fused);
+
+    v = a;
+    v.normalize();
+    EXPECT_NEAR(v.norm(), 1, 1e-15);
+    for (size_t i = 0; i < DIM; ++i)
+        EXPECT_DOUBLE_EQ(v[i], a[i] / a.norm());
+}
+
+TEST_F(VectorTest, Kernels) {
+    EXPECT_EQ(sizeof(vector3), 3 * sizeof(double));
+    testKernels<2>();
+    testKernels<3>();
+    testKernels<4>();
+    testKernels<5>();
+}
+
+template <size_t DIM>
+void testFusedKernels() {
+    // x * x = 1 + 2^-26 + 2^-54, so x * x - (1 + 2^-26) is only nonzero when
+    // the product is not rounded before the addition.
+    const double x = 1 + std::ldexp(1.0, -27);
+    Vector<DIM> a, y;
+    for (size_t i = 0; i < DIM; ++i) {
+        a[i] = x;
+        y[i] = -(1 + std::ldexp(1.0, -26));
+    }
+#if defined(FP_FAST_FMA)
+    const double expected = std::ldexp(1.0, -54);
+#else
+    const double expected = 0;
+#endif
+
+    Vector<DIM> r = y.addScaled(a, x);
+    for (size_t i = 0; i < DIM; ++i)
+        EXPECT_EQ(r[i], expected);
+    EXPECT_EQ(y.axpy(x, a), r);
+}
+
+TEST_F(VectorTest, FusedKernels) {
+    testFusedKernels<2>();
+    testFusedKernels<3>();
+    testFusedKernels<4>();
+    testFusedKernels<5>();
+}
+
+TEST_F(VectorTest, NormPrecision) {
+    for (int trial = 0; trial < 100; ++trial) {
+        vector3 v = createVector<3>();
+        double exact = 1 / v.norm();
+        EXPECT_DOUBLE_EQ(v.inverseNorm(), exact);
+        EXPECT_DOUBLE_EQ(v.inverseNorm(NormPrecision::exact), exact);
+        EXPECT_NEAR(v.inverseNorm(NormPrecision::refined), exact, 1e-5 * exact);
+        EXPECT_NEAR(v.inverseNorm(NormPrecision::raw), exact, 4e-3 * exact);
+
+        vector3 direction = v.direction();
+        vector3 inverseSquare = v.inverseSquare();
+        vector3 approximate = v.inverseSquare(NormPrecision::refined);
+        for (size_t i = 0; i < 3; ++i) {
+            EXPECT_DOUBLE_EQ(direction[i], vector3(v).normalize()[i]);
+            EXPECT_NEAR(inverseSquare[i], v[i] / v.normSq() / v.norm(), 1e-15 * std::abs(v[i]) * exact * exact * exact);
+            EXPECT_NEAR(approximate[i], inverseSquare[i], 4e-5 * std::abs(inverseSquare[i]));
+        }
+    }
+
+    // Outside the range of float the approximations fall back to exact.
+    const double hugeData[] = {3e20, 4e20};
+    vector2 huge(hugeData);
+    EXPECT_DOUBLE_EQ(huge.inverseNorm(NormPrecision::raw), 1 / 5e20);
+}
+
+TEST_F(VectorTest, CompensatedSummation) {
+    // Each 2^-60 is below half an ulp of 1, so a naive sum drops all of them.
+    const double tiny = std::ldexp(1.0, -60);
+    CompensatedSum<> sum(1.0);
+    double naive = 1.0;
+    for (int i = 0; i < 1024; ++i) {
+        sum += tiny;
+        naive += tiny;
+    }
+    EXPECT_EQ(naive, 1.0);
+    EXPECT_EQ(sum.sum(), 1.0 + std::ldexp(1.0, -50));
+
+    // Terms larger than the running sum are handled as well.
+    CompensatedSum<> cancel;
+    cancel += 1.0;
+    cancel += 1e100;
+    cancel += 1.0;
+    cancel += -1e100;
+    EXPECT_EQ(cancel.sum(), 2.0);
+
+    const double bigData[] = {1e16, 1, -1e16};
+    const double onesData[] = {1, 1, 1};
+    vector3 big(bigData), ones(onesData);
+    EXPECT_EQ(big.dot(ones, Summation::compensated), 1.0);
+    EXPECT_EQ(big.dot(ones, Summation::naive), big.dot(ones));
+
+    const double termData[] = {1e100, 1, 1, 1e100, -1e100, -1e100};
+    CompensatedSum<vector2> vectors;
+    for (int i = 0; i < 3; ++i)
+        vectors += vector2(termData + 2 * i);
+    EXPECT_EQ(vectors.sum().toString(), "[1 1]");
+}
+
+TEST_F(VectorTest, ScalarTypes) {
+    const float fdata[] = {1, 2, 3};
+    vector3f f(fdata);
+    EXPECT_EQ(sizeof(vector3f), 3 * sizeof(float));
+    EXPECT_EQ((2 * f + f).toString(), "[3 6 9]");
+    EXPECT_FLOAT_EQ(f * f, 14);
+    EXPECT_EQ(f ^ f, vector3f());
+    EXPECT_FLOAT_EQ(vector3f(f).normalize().norm(), 1);
+
+    // Conversions are explicit and component-wise.
+    vector3 d(f);
+    EXPECT_EQ(d, vector3(data + 1));
+    vector3l l(d * 0.5);
+    EXPECT_EQ(l.toString(), "[0.5 1 1.5]");
+    EXPECT_EQ(vector3f(l), f / 2);
+
+    // Mixed precision products accumulate in the requested type.
+    float big[] = {16777216.0f, 1.0f};
+    float one[] = {1.0f, 1.0f};
+    vector2f a(big), b(one);
+    EXPECT_EQ(a * b, 16777216.0f);
+    EXPECT_EQ(dotAs<double>(a, b), 16777217.0);
+    EXPECT_EQ(dotAs<double>(a, vector2(b)), 16777217.0);
+    EXPECT_EQ(normSqAs<long double>(l), 3.5L);
+}
+
+namespace {
+constexpr double axes[] = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+constexpr vector3 xAxis(axes), yAxis(axes + 3), zAxis(axes + 6);
+
+constexpr vector3 spiral(size_t turns) {
+    vector3 p;
+    for (size_t i = 0; i < turns; ++i)
+        p = (p ^ zAxis) + xAxis;
+    return p;
+}
+}
+
+TEST_F(VectorTest, ConstantExpressions) {
+    static_assert((xAxis ^ yAxis) == zAxis, "x cross y is z");
+    static_assert(xAxis * yAxis == 0, "axes are orthogonal");
+    static_assert((2 * xAxis + yAxis - zAxis / 2).normSq() == 5.25, "normSq");
+    static_assert(xAxis.add(yAxis).scale(3)[1] == 3, "add and scale");
+    static_assert(spiral(4) == vector3(), "four quarter turns close the loop");
+
+    constexpr vector3 baked = spiral(3);
+    vector3 runtime;
+    for (size_t i = 0; i < 3; ++i)
+        runtime = (runtime ^ zAxis) + xAxis;
+    EXPECT_EQ(baked, runtime);
+    vector3 sum = xAxis;
+    sum += yAxis;
+    sum -= zAxis;
+    sum *= 2;
+    EXPECT_EQ(sum, xAxis.add(yAxis).add(zAxis.invert()).scale(2));
+}